@@ -0,0 +1,74 @@
+/* adc_filters.h - INTEGER PRIMITIVES FOR 12-BIT ADC CODES, NO MALLOC */
+#ifndef adc_filters_h
+#define adc_filters_h
+
+#include <stdint.h>
+
+#if __cplusplus
+extern "C"{
+#endif
+
+// Adds, compares and shifts only (the M0+ has no divider), a handful per sample.
+// Inputs are unsigned codes: up to 16 bits for the average and median, 14 for the
+// DC blocker. Each stage can feed the next or the float Butterworth stages.
+
+// Window lengths. The moving average uses a power of two so the mean is a shift.
+#define MA_MAX_LOG2         5   // up to 32 samples
+#define MEDIAN_MAX_LEN      9   // odd
+
+#if (MEDIAN_MAX_LEN & 1) == 0
+#error "MEDIAN_MAX_LEN must be odd"
+#endif
+
+// Running sum: add the new sample, subtract the one leaving the window.
+typedef struct {
+    uint8_t shift;
+    uint8_t pos;
+    uint32_t sum;
+    uint16_t buf[1 << MA_MAX_LOG2];
+} MovingAverage;
+
+// Time-ordered ring plus a sorted copy. Each sample removes the outgoing value from
+// the sorted copy and inserts the new one by shifting (at most len moves); the
+// median is the middle element.
+typedef struct {
+    uint8_t len;
+    uint8_t pos;
+    uint16_t ring[MEDIAN_MAX_LEN];
+    uint16_t sorted[MEDIAN_MAX_LEN];
+} MedianFilter;
+
+// y[n] = x[n] - x[n-1] + (1 - 2^-k) y[n-1], state kept with 16 fractional bits so
+// the shift does not leave a DC residue. -3 dB at about s * 2^-k / (2 pi):
+// k = 6 is 2.5 Hz at 1 kHz. Output is signed, centred on 0.
+typedef struct {
+    uint8_t k;
+    uint16_t x1;
+    int32_t acc;
+} DCBlocker;
+
+// 'len' is rounded down to a power of two, 1..2^MA_MAX_LOG2.
+void init_moving_average(MovingAverage* ma, int len);
+// 'len' is clamped to 1..MEDIAN_MAX_LEN and made odd.
+void init_median(MedianFilter* m, int len);
+// 'k' is clamped to 1..15.
+void init_dc_blocker(DCBlocker* d, int k);
+
+// Steady state for a constant input x, as the bw_*_prime() functions.
+void moving_average_prime(MovingAverage* ma, uint16_t x);
+void median_prime(MedianFilter* m, uint16_t x);
+void dc_blocker_prime(DCBlocker* d, uint16_t x);
+
+uint16_t moving_average(MovingAverage* ma, uint16_t x);
+uint16_t median_filter(MedianFilter* m, uint16_t x);
+int16_t dc_blocker(DCBlocker* d, uint16_t x);
+
+// 'in' and 'out' may point to the same buffer.
+void moving_average_block(MovingAverage* ma, const uint16_t* in, uint16_t* out, int n);
+void median_filter_block(MedianFilter* m, const uint16_t* in, uint16_t* out, int n);
+void dc_blocker_block(DCBlocker* d, const uint16_t* in, int16_t* out, int n);
+
+#if __cplusplus
+}
+#endif
+#endif
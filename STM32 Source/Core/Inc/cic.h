@@ -0,0 +1,52 @@
+/* cic.h - INTEGER CIC DECIMATOR, NO MALLOC */
+#ifndef cic_h
+#define cic_h
+
+#include <stdint.h>
+#include "fir.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+#define CIC_MAX_ORDER   5
+// Unsigned ADC codes of up to this many bits. The registers wrap modulo 2^32,
+// which is exact as long as the output, input * rate^order, fits 32 bits.
+#define CIC_INPUT_BITS  12
+// Longest compensator. Its design solves taps/2 + 1 normal equations on the stack,
+// (taps/2 + 1)(taps/2 + 2) floats: 11 taps is 168 bytes of the 1 KB stack.
+#ifndef CIC_COMP_MAX_TAPS
+#define CIC_COMP_MAX_TAPS   11
+#endif
+
+// N integrators at the input rate, decimation by 'rate', N combs (delay 1) at the
+// output rate. Adds only; DC gain is rate^order.
+typedef struct {
+    int order;
+    int rate;
+    int count;
+    uint32_t integ[CIC_MAX_ORDER];
+    uint32_t comb[CIC_MAX_ORDER];
+} CICDecimator;
+
+// 'order' is clamped to 1..CIC_MAX_ORDER; 'rate' is lowered until
+// rate^order <= 2^(32 - CIC_INPUT_BITS).
+void init_cic(CICDecimator* cic, int order, int rate);
+void cic_reset(CICDecimator* cic);
+uint32_t cic_gain(const CICDecimator* cic);
+
+// Feeds one input sample. Every 'rate' calls it writes *out and returns 1.
+int cic_decimate(CICDecimator* cic, uint16_t x, uint32_t* out);
+// Returns the number of outputs written (at most n / rate + 1).
+int cic_decimate_block(CICDecimator* cic, const uint16_t* in, int n, uint32_t* out);
+
+// Short symmetric FIR at the output rate that flattens the CIC droop up to
+// 'cutoff' (fraction of the output rate, < 0.5) and removes the rate^order gain,
+// so its output is back in input units and can go straight into the bw_* filters.
+// 'taps' is made odd and clamped to CIC_COMP_MAX_TAPS (and FIR_MAX_TAPS - 1).
+void init_cic_compensator(FIRFilter* fir, const CICDecimator* cic, int taps, FTR_PRECISION cutoff);
+
+#if __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,43 @@
+/* crossfade.h - GLITCH-FREE SWITCHING BETWEEN FILTERS, NO MALLOC */
+#ifndef crossfade_h
+#define crossfade_h
+
+#include <stdint.h>
+#include "filter.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+// Two ways to change a filter mid-stream without a step in the output:
+//  - crossfade(): run the outgoing and incoming filters side by side and ramp
+//    linearly from one to the other over 'len' samples. Both filter the same
+//    input, so the outputs are correlated and a linear (constant-sum) ramp keeps
+//    the level. Costs both filters for 'len' samples, never more.
+//  - crossfade_offset_block(): when only the new output exists (the old state is
+//    gone), add the step 'offset' = old - new at the switch and let it decay
+//    linearly to 0 over 'len' samples. One multiply-add per sample.
+typedef struct {
+    uint16_t len;
+    uint16_t pos;           // == len when idle
+    FTR_PRECISION step;     // 1 / len
+    FTR_PRECISION offset;
+} Crossfade;
+
+// 'len' is clamped to 1..65535 samples.
+void init_crossfade(Crossfade* x, int len);
+void crossfade_start(Crossfade* x, FTR_PRECISION offset);
+int crossfade_active(const Crossfade* x);
+
+// Returns 'from' weighted by 1 - g plus 'to' weighted by g, g rising to 1 on the
+// last sample of the fade; 'to' once idle.
+FTR_PRECISION crossfade(Crossfade* x, FTR_PRECISION from, FTR_PRECISION to);
+// to[k] = crossfade(x, from[k], to[k]).
+void crossfade_block(Crossfade* x, const FTR_PRECISION* from, FTR_PRECISION* to, int n);
+// buf[k] += offset * (1 - g).
+void crossfade_offset_block(Crossfade* x, FTR_PRECISION* buf, int n);
+
+#if __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,43 @@
+/* fft.h - IN-PLACE FIXED POINT (Q15) REAL FFT, NO MALLOC */
+#ifndef fft_h
+#define fft_h
+
+#include <stdint.h>
+#include "filter_q.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+// Largest real transform, 2^FFT_MAX_LOG2 points (1 KB of q15 samples).
+#define FFT_MAX_LOG2        9
+
+#define FFT_WINDOW_NONE     0
+#define FFT_WINDOW_HANN     1   // coherent gain 0.50, sidelobes -31 dB
+#define FFT_WINDOW_BLACKMAN 2   // coherent gain 0.42, sidelobes -58 dB
+
+// Periodic window over n samples, in place. Twiddles and windows come from the
+// shared sine table (ftr_sin_q15), so no coefficient tables are stored.
+void fft_window_q15(q15_t* x, int n, int window);
+
+// Radix-2 decimation in time over 2^log2n complex points, interleaved re/im, in
+// place. Every stage halves with rounding, so the result is X / n and cannot
+// overflow.
+void fft_complex_q15(q15_t* x, int log2n);
+
+// Real transform of n = 2^log2n samples as one n/2-point complex FFT plus a split
+// pass, in place. Output: x[2k], x[2k+1] = re, im of X[k] / n for k = 1..n/2-1;
+// x[0] = X[0] / n (DC) and x[1] = X[n/2] / n (Nyquist), both real. A sine of
+// amplitude A on a bin centre reads A/2 times the window's coherent gain.
+void fft_real_q15(q15_t* x, int log2n);
+
+// |X[k]|^2 in Q30 for k = 0..n/2-1 (bin 0 is DC, the Nyquist term is dropped).
+void fft_mag2_q15(const q15_t* X, int n, uint32_t* mag2);
+// The same as 8 * log2(|X[k]|^2) in one byte (0.75 dB steps, 0 for silence), for
+// compact spectrum frames. 'out' may alias X.
+void fft_log_mag_q15(const q15_t* X, int n, uint8_t* out);
+
+#if __cplusplus
+}
+#endif
+#endif
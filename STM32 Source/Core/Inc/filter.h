@@ -9,50 +9,55 @@ extern "C"{
 #define FTR_PRECISION float
 #define M_PI 3.1415927f
 
-// Max order 4 means n=2 for LPF/HPF, n=1 for BPF/BSF.
-// We set array size to 2 to cover all cases safely.
+// Max order 4 means n=2 for LPF/HPF.
 #define MAX_SECTIONS 2
 
+// The numerator is always (1, 2, 1) for LPF and (1, -2, 1) for HPF, so the kernels
+// build it from adds and apply the per-section gains once, as G = A[0]*...*A[n-1].
 typedef struct {
     int n;
+    FTR_PRECISION G;
     FTR_PRECISION A[MAX_SECTIONS];
     FTR_PRECISION d1[MAX_SECTIONS];
     FTR_PRECISION d2[MAX_SECTIONS];
-    FTR_PRECISION w0[MAX_SECTIONS];
     FTR_PRECISION w1[MAX_SECTIONS];
     FTR_PRECISION w2[MAX_SECTIONS];
 } BWLowPass;
 typedef BWLowPass BWHighPass;
 
-typedef struct {
-    int n;
-    FTR_PRECISION A[MAX_SECTIONS];
-    FTR_PRECISION d1[MAX_SECTIONS];
-    FTR_PRECISION d2[MAX_SECTIONS];
-    FTR_PRECISION d3[MAX_SECTIONS];
-    FTR_PRECISION d4[MAX_SECTIONS];
-    FTR_PRECISION w0[MAX_SECTIONS];
-    FTR_PRECISION w1[MAX_SECTIONS];
-    FTR_PRECISION w2[MAX_SECTIONS];
-    FTR_PRECISION w3[MAX_SECTIONS];
-    FTR_PRECISION w4[MAX_SECTIONS];
-} BWBandPass;
+// Generic cascade of second-order sections:
+// H(z) = prod (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+// SOS_MAX_SECTIONS biquads give order 2*SOS_MAX_SECTIONS for every response type.
+#ifndef SOS_MAX_SECTIONS
+#define SOS_MAX_SECTIONS 4
+#endif
 
 typedef struct {
     int n;
-    FTR_PRECISION r;
-    FTR_PRECISION s;
-    FTR_PRECISION A[MAX_SECTIONS];
-    FTR_PRECISION d1[MAX_SECTIONS];
-    FTR_PRECISION d2[MAX_SECTIONS];
-    FTR_PRECISION d3[MAX_SECTIONS];
-    FTR_PRECISION d4[MAX_SECTIONS];
-    FTR_PRECISION w0[MAX_SECTIONS];
-    FTR_PRECISION w1[MAX_SECTIONS];
-    FTR_PRECISION w2[MAX_SECTIONS];
-    FTR_PRECISION w3[MAX_SECTIONS];
-    FTR_PRECISION w4[MAX_SECTIONS];
-} BWBandStop;
+    FTR_PRECISION G;    // product of the b0, set by init_bw_low/high_pass_sos for the _lp/_hp kernels
+    FTR_PRECISION b0[SOS_MAX_SECTIONS];
+    FTR_PRECISION b1[SOS_MAX_SECTIONS];
+    FTR_PRECISION b2[SOS_MAX_SECTIONS];
+    FTR_PRECISION a1[SOS_MAX_SECTIONS];
+    FTR_PRECISION a2[SOS_MAX_SECTIONS];
+    FTR_PRECISION w1[SOS_MAX_SECTIONS];
+    FTR_PRECISION w2[SOS_MAX_SECTIONS];
+} SOSCascade;
+
+// Band types are biquad cascades: every 4th-order band section is factored into
+// two second-order sections at design time, up to order 2*SOS_MAX_SECTIONS.
+typedef SOSCascade BWBandPass;
+typedef SOSCascade BWBandStop;
+
+// Table-driven trig used by every designer; fixed cost, error < 3e-5.
+FTR_PRECISION ftr_sin(FTR_PRECISION x);
+FTR_PRECISION ftr_cos(FTR_PRECISION x);
+FTR_PRECISION ftr_tan(FTR_PRECISION x);
+// Scalar helpers for designers (init time only); float accurate, no libm.
+FTR_PRECISION ftr_sqrt(FTR_PRECISION x);
+FTR_PRECISION ftr_exp(FTR_PRECISION x);
+FTR_PRECISION ftr_log(FTR_PRECISION x);
+FTR_PRECISION ftr_atan2(FTR_PRECISION y, FTR_PRECISION x);
 
 // Changed to 'init' functions that take a pointer, instead of returning one
 void init_bw_low_pass(BWLowPass* filter, int order, FTR_PRECISION s, FTR_PRECISION f);
@@ -60,11 +65,59 @@ void init_bw_high_pass(BWHighPass* filter, int order, FTR_PRECISION s, FTR_PRECI
 void init_bw_band_pass(BWBandPass* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu);
 void init_bw_band_stop(BWBandStop* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu);
 
+// Butterworth designs emitted as biquads. LPF/HPF use order/2 sections, the band
+// types split every 4th-order band section into two biquads (order/2 total).
+void init_bw_low_pass_sos(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f);
+void init_bw_high_pass_sos(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f);
+void init_bw_band_pass_sos(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu);
+void init_bw_band_stop_sos(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu);
+void sos_reset(SOSCascade* filter);
+
+// Steady-state priming (the lfilter_zi equivalent): loads the state the filter
+// settles to under a constant input x, so a signal that starts at x gives valid
+// output from the first sample instead of after the settling time. Use the
+// current sample when starting or switching filters. sos_prime() is for the
+// Direct Form II kernels (sos_cascade, sos_cascade_block), sos_prime_tdf2() for
+// the transposed ones.
+void bw_low_pass_prime(BWLowPass* filter, FTR_PRECISION x);
+void bw_high_pass_prime(BWHighPass* filter, FTR_PRECISION x);
+void bw_band_pass_prime(BWBandPass* filter, FTR_PRECISION x);
+void bw_band_stop_prime(BWBandStop* filter, FTR_PRECISION x);
+void sos_prime(SOSCascade* filter, FTR_PRECISION x);
+void sos_prime_lp(SOSCascade* filter, FTR_PRECISION x);
+void sos_prime_hp(SOSCascade* filter, FTR_PRECISION x);
+void sos_prime_tdf2(SOSCascade* filter, FTR_PRECISION x);
+
 FTR_PRECISION bw_low_pass(BWLowPass* filter, FTR_PRECISION input);
 FTR_PRECISION bw_high_pass(BWHighPass* filter, FTR_PRECISION input);
 FTR_PRECISION bw_band_pass(BWBandPass* filter, FTR_PRECISION input);
 FTR_PRECISION bw_band_stop(BWBandStop* filter, FTR_PRECISION input);
 
+// One kernel for every response type designed into an SOSCascade.
+FTR_PRECISION sos_cascade(SOSCascade* filter, FTR_PRECISION input);
+// Transposed Direct Form II over the same coefficients: y = b0*x + s1 is the only
+// serial step per section. w1/w2 then hold s1/s2, so call sos_reset() before
+// switching a running cascade between the two forms.
+FTR_PRECISION sos_cascade_tdf2(SOSCascade* filter, FTR_PRECISION input);
+// Add-only numerators for init_bw_low_pass_sos/init_bw_high_pass_sos designs, as
+// bw_low_pass/bw_high_pass: each section builds (1, +-2, 1) from adds and the
+// section gains are applied once as G, up to SOS_MAX_SECTIONS. The state is the
+// unscaled one, so prime with sos_prime_lp/hp and call sos_reset() before moving a
+// running cascade between these and the generic kernels.
+FTR_PRECISION sos_cascade_lp(SOSCascade* filter, FTR_PRECISION input);
+FTR_PRECISION sos_cascade_hp(SOSCascade* filter, FTR_PRECISION input);
+
+// Block versions: run each section over the whole block with its state held in
+// locals. 'in' and 'out' may point to the same buffer.
+void bw_low_pass_block(BWLowPass* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n);
+void bw_high_pass_block(BWHighPass* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n);
+void bw_band_pass_block(BWBandPass* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n);
+void bw_band_stop_block(BWBandStop* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n);
+void sos_cascade_block(SOSCascade* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n);
+void sos_cascade_tdf2_block(SOSCascade* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n);
+void sos_cascade_lp_block(SOSCascade* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n);
+void sos_cascade_hp_block(SOSCascade* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n);
+
 #if __cplusplus
 }
 #endif
@@ -0,0 +1,214 @@
+/* filter.hpp - COMPILE-TIME BUTTERWORTH, HEADER ONLY, NO MALLOC
+ *
+ * Coefficients are computed by the compiler in double precision and stored as
+ * float constants, so nothing is designed at boot and no approximated trig is
+ * linked in. Cutoffs are template arguments in Hz. Needs C++14.
+ *
+ *   ButterworthLowPass<4, 1000, 15> lpf;
+ *   float y = lpf.process(x);
+ *
+ * Use filter_precision.hpp or the C API in filter.h for cutoffs chosen at runtime.
+ */
+#ifndef filter_hpp
+#define filter_hpp
+
+#include "filter.h"
+
+namespace bw {
+
+namespace detail {
+
+constexpr double pi = 3.14159265358979323846;
+
+// Taylor series after reduction to [-pi/2, pi/2]; error is below 1e-16.
+constexpr double sin(double x) {
+    double turns = x / (2.0 * pi);
+    long long k = (long long)(turns < 0 ? turns - 0.5 : turns + 0.5);
+    x -= (double)k * 2.0 * pi;
+    if (x > pi / 2) x = pi - x;
+    if (x < -pi / 2) x = -pi - x;
+    double term = x, sum = x;
+    for (int n = 1; n < 14; ++n) {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cos(double x) { return sin(x + pi / 2); }
+constexpr double tan(double x) { return sin(x) / cos(x); }
+
+constexpr double sqrt(double x) {
+    if (x <= 0) return 0;
+    double y = x < 1 ? 1 : x;
+    for (int k = 0; k < 64; ++k) {
+        double next = 0.5 * (y + x / y);
+        if (next == y) break;
+        y = next;
+    }
+    return y;
+}
+
+// T is the storage type; the design itself is always carried out in double.
+template <int N, class T = float>
+struct Sos {
+    T b0[N] = {}, b1[N] = {}, b2[N] = {};
+    T a1[N] = {}, a2[N] = {};
+};
+
+template <int N, class T = float>
+constexpr Sos<N, T> design_low_high(double fs, double fc, bool high) {
+    Sos<N, T> d;
+    double a = tan(pi * fc / fs);
+    double a2 = a * a;
+    for (int i = 0; i < N; ++i) {
+        double r = sin(pi * (2.0 * i + 1.0) / (4.0 * N));
+        double s = a2 + 2.0 * a * r + 1.0;
+        double A = (high ? 1.0 : a2) / s;
+        d.b0[i] = (T)A;
+        d.b1[i] = (T)((high ? -2.0 : 2.0) * A);
+        d.b2[i] = (T)A;
+        d.a1[i] = (T)(-2.0 * (1.0 - a2) / s);
+        d.a2[i] = (T)((a2 - 2.0 * a * r + 1.0) / s);
+    }
+    return d;
+}
+
+// Same pole mapping as init_bw_band_pass_sos, carried out in double.
+template <int N, class T = float>
+constexpr Sos<N, T> design_band(double fs, double fl, double fu, bool stop) {
+    Sos<N, T> d;
+    const int n4 = N / 2;
+    double a = cos(pi * (fu + fl) / fs) / cos(pi * (fu - fl) / fs);
+    double b = tan(pi * (fu - fl) / fs);
+    double b2 = b * b;
+    for (int i = 0; i < n4; ++i) {
+        double r = sin(pi * (2.0 * i + 1.0) / (4.0 * n4));
+        double s = b2 + 2.0 * b * r + 1.0;
+        double g = sqrt((stop ? 1.0 : b2) / s);
+
+        double d1 = 2.0 * (1.0 - b2) / s;
+        double d2 = -(b2 - 2.0 * b * r + 1.0) / s;
+        double q_re = 0.5 * d1, q_im = 0.5 * sqrt(-(d1 * d1 + 4.0 * d2));
+
+        double c_re = a * (1.0 + q_re), c_im = a * q_im;
+        double z_re = c_re * c_re - c_im * c_im - 4.0 * q_re;
+        double z_im = 2.0 * c_re * c_im - 4.0 * q_im;
+        double m = sqrt(z_re * z_re + z_im * z_im);
+        double s_re = sqrt(0.5 * (m + z_re));
+        double s_im = sqrt(0.5 * (m - z_re));
+        if (z_im < 0) s_im = -s_im;
+
+        for (int k = 0; k < 2; ++k) {
+            int j = 2 * i + k;
+            double sign = k ? -1.0 : 1.0;
+            double p_re = 0.5 * (c_re + sign * s_re);
+            double p_im = 0.5 * (c_im + sign * s_im);
+            d.a1[j] = (T)(-2.0 * p_re);
+            d.a2[j] = (T)(p_re * p_re + p_im * p_im);
+            d.b0[j] = (T)g;
+            d.b1[j] = (T)(stop ? -2.0 * a * g : 0.0);
+            d.b2[j] = (T)(stop ? g : -g);
+        }
+    }
+    return d;
+}
+
+// Recursion over the section index so every section is expanded inline with
+// its coefficients folded in as constants. Transposed Direct Form II.
+template <class D, int I, int N>
+struct Unroll {
+    static inline float run(float* s1, float* s2, float x) {
+        constexpr float b0 = D::design.b0[I], b1 = D::design.b1[I], b2 = D::design.b2[I];
+        constexpr float a1 = D::design.a1[I], a2 = D::design.a2[I];
+        float y = b0 * x + s1[I];
+        s1[I] = b1 * x + s2[I] - a1 * y;
+        s2[I] = b2 * x - a2 * y;
+        return Unroll<D, I + 1, N>::run(s1, s2, y);
+    }
+};
+
+template <class D, int N>
+struct Unroll<D, N, N> {
+    static inline float run(float*, float*, float x) { return x; }
+};
+
+// Only the state lives in RAM; the design is a constexpr member of D.
+template <class D, int N>
+class Cascade {
+public:
+    static constexpr int sections = N;
+
+    float process(float x) { return Unroll<D, 0, N>::run(s1_, s2_, x); }
+
+    void process(const float* in, float* out, int n) {
+        for (int k = 0; k < n; ++k) out[k] = process(in[k]);
+    }
+
+    void reset() {
+        for (int i = 0; i < N; ++i) { s1_[i] = 0; s2_[i] = 0; }
+    }
+
+    // Steady state for a constant input x, as sos_prime_tdf2().
+    void prime(float x) {
+        for (int i = 0; i < N; ++i) {
+            const Sos<N>& d = D::design;
+            float y = (d.b0[i] + d.b1[i] + d.b2[i]) * x / (1.0f + d.a1[i] + d.a2[i]);
+            s1_[i] = y - d.b0[i] * x;
+            s2_[i] = d.b2[i] * x - d.a2[i] * y;
+            x = y;
+        }
+    }
+
+private:
+    float s1_[N] = {};
+    float s2_[N] = {};
+};
+
+} // namespace detail
+
+template <int Order, unsigned long Fs, unsigned long Fc>
+class ButterworthLowPass : public detail::Cascade<ButterworthLowPass<Order, Fs, Fc>, Order / 2> {
+    static_assert(Order >= 2 && Order % 2 == 0, "order must be even");
+    static_assert(2 * Fc < Fs, "cutoff must be below Nyquist");
+public:
+    static constexpr detail::Sos<Order / 2> design = detail::design_low_high<Order / 2>(Fs, Fc, false);
+};
+
+template <int Order, unsigned long Fs, unsigned long Fc>
+class ButterworthHighPass : public detail::Cascade<ButterworthHighPass<Order, Fs, Fc>, Order / 2> {
+    static_assert(Order >= 2 && Order % 2 == 0, "order must be even");
+    static_assert(2 * Fc < Fs, "cutoff must be below Nyquist");
+public:
+    static constexpr detail::Sos<Order / 2> design = detail::design_low_high<Order / 2>(Fs, Fc, true);
+};
+
+template <int Order, unsigned long Fs, unsigned long Fl, unsigned long Fu>
+class ButterworthBandPass : public detail::Cascade<ButterworthBandPass<Order, Fs, Fl, Fu>, Order / 2> {
+    static_assert(Order >= 4 && Order % 4 == 0, "band order must be a multiple of 4");
+    static_assert(Fl < Fu && 2 * Fu < Fs, "need Fl < Fu < Fs/2");
+public:
+    static constexpr detail::Sos<Order / 2> design = detail::design_band<Order / 2>(Fs, Fl, Fu, false);
+};
+
+template <int Order, unsigned long Fs, unsigned long Fl, unsigned long Fu>
+class ButterworthBandStop : public detail::Cascade<ButterworthBandStop<Order, Fs, Fl, Fu>, Order / 2> {
+    static_assert(Order >= 4 && Order % 4 == 0, "band order must be a multiple of 4");
+    static_assert(Fl < Fu && 2 * Fu < Fs, "need Fl < Fu < Fs/2");
+public:
+    static constexpr detail::Sos<Order / 2> design = detail::design_band<Order / 2>(Fs, Fl, Fu, true);
+};
+
+// C++14 still wants namespace-scope definitions for static constexpr members.
+template <int Order, unsigned long Fs, unsigned long Fc>
+constexpr detail::Sos<Order / 2> ButterworthLowPass<Order, Fs, Fc>::design;
+template <int Order, unsigned long Fs, unsigned long Fc>
+constexpr detail::Sos<Order / 2> ButterworthHighPass<Order, Fs, Fc>::design;
+template <int Order, unsigned long Fs, unsigned long Fl, unsigned long Fu>
+constexpr detail::Sos<Order / 2> ButterworthBandPass<Order, Fs, Fl, Fu>::design;
+template <int Order, unsigned long Fs, unsigned long Fl, unsigned long Fu>
+constexpr detail::Sos<Order / 2> ButterworthBandStop<Order, Fs, Fl, Fu>::design;
+
+} // namespace bw
+
+#endif
@@ -0,0 +1,55 @@
+/* filter_bank.h - MULTI-CHANNEL SOS CASCADE, NO MALLOC */
+#ifndef filter_bank_h
+#define filter_bank_h
+
+#include "filter.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+#ifndef BANK_MAX_CHANNELS
+#define BANK_MAX_CHANNELS 4
+#endif
+
+// One design shared by up to BANK_MAX_CHANNELS channels. The state is laid out
+// channel-minor (w1[section][channel]) so the inner loop of every section runs
+// over contiguous channels with the coefficients held in registers.
+typedef struct {
+    int n;
+    int channels;
+    FTR_PRECISION b0[SOS_MAX_SECTIONS];
+    FTR_PRECISION b1[SOS_MAX_SECTIONS];
+    FTR_PRECISION b2[SOS_MAX_SECTIONS];
+    FTR_PRECISION a1[SOS_MAX_SECTIONS];
+    FTR_PRECISION a2[SOS_MAX_SECTIONS];
+    FTR_PRECISION w1[SOS_MAX_SECTIONS][BANK_MAX_CHANNELS];
+    FTR_PRECISION w2[SOS_MAX_SECTIONS][BANK_MAX_CHANNELS];
+} SOSBank;
+
+// Copies the coefficients of a designed cascade (e.g. from init_bw_low_pass_sos)
+// and clears the state. 'channels' is clamped to 1..BANK_MAX_CHANNELS.
+void sos_bank_init(SOSBank* bank, const SOSCascade* design, int channels);
+void sos_bank_reset(SOSBank* bank);
+// Steady state for a constant frame x[channels], as sos_prime().
+void sos_bank_prime(SOSBank* bank, const FTR_PRECISION* x);
+
+// One sample per channel. Each channel sees exactly what sos_cascade() would give
+// it (on hosts, as long as filter.c is not built with FMA contraction).
+// 'in' and 'out' may point to the same buffer.
+void sos_bank_process_frame(SOSBank* bank, const FTR_PRECISION* in, FTR_PRECISION* out);
+// 'frames' interleaved frames: in[k*channels + c] is sample k of channel c.
+void sos_bank_process_block(SOSBank* bank, const FTR_PRECISION* in, FTR_PRECISION* out, int frames);
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+// Host builds (filter_bank_x86.c): 8 or 16 channels per instruction, picked at run
+// time by sos_bank_process_block(). Each runs the full chunks from channel c0 on and
+// returns the first channel it left; results are bit-identical to the scalar path.
+int sos_bank_block_avx2(SOSBank* bank, const float* in, float* out, int frames, int c0);
+int sos_bank_block_avx512(SOSBank* bank, const float* in, float* out, int frames, int c0);
+#endif
+
+#if __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,40 @@
+/* filter_cpx.h - COMPLEX HELPERS FOR THE DESIGNERS, NO LIBM */
+#ifndef filter_cpx_h
+#define filter_cpx_h
+
+#include "filter.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+// Pole/zero arithmetic for filter.c and filter_design.c. Init time only.
+typedef struct { float re, im; } cpx;
+
+static inline cpx cx(float re, float im) { cpx r = { re, im }; return r; }
+static inline cpx c_add(cpx a, cpx b) { return cx(a.re + b.re, a.im + b.im); }
+static inline cpx c_sub(cpx a, cpx b) { return cx(a.re - b.re, a.im - b.im); }
+static inline cpx c_mul(cpx a, cpx b) { return cx(a.re*b.re - a.im*b.im, a.re*b.im + a.im*b.re); }
+static inline cpx c_scale(cpx a, float k) { return cx(a.re * k, a.im * k); }
+static inline float c_abs2(cpx a) { return a.re*a.re + a.im*a.im; }
+
+static inline cpx c_div(cpx a, cpx b) {
+    float d = c_abs2(b);
+    return cx((a.re*b.re + a.im*b.im) / d, (a.im*b.re - a.re*b.im) / d);
+}
+
+// Principal root, on the same side of the real axis as z.
+static inline cpx c_sqrt(cpx z) {
+    float m = ftr_sqrt(c_abs2(z));
+    cpx r = { ftr_sqrt(0.5f * (m + z.re)), ftr_sqrt(0.5f * (m - z.re)) };
+    if (z.im < 0) r.im = -r.im;
+    return r;
+}
+
+// Bilinear transform with the prewarp folded into s: z = (1+s)/(1-s).
+static inline cpx bilinear(cpx s) { return c_div(c_add(cx(1, 0), s), c_sub(cx(1, 0), s)); }
+
+#if __cplusplus
+}
+#endif
+#endif
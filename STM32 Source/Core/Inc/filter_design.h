@@ -0,0 +1,64 @@
+/* filter_design.h - CHEBYSHEV, BESSEL, ELLIPTIC AND NOTCH DESIGNS, NO MALLOC */
+#ifndef filter_design_h
+#define filter_design_h
+
+#include "filter.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+// Every designer emits biquads into an SOSCascade, so the result runs on the same
+// kernels as the Butterworth designs (sos_cascade, sos_cascade_block, SOSBank,
+// sos_filtfilt, and the Q15/Q31 quantizers when the coefficients fit).
+//
+// Section gains are set so the response up to each section output peaks at 1 (on
+// the grid the designer searches), unless that would put a numerator outside the
+// Q2.x range of filter_q.h: such a section keeps what fits and the sections before
+// it run hotter instead. Deep, wide band-stops give up the most internal headroom
+// this way; a design that still cannot fit makes sos_quantize_q15/q31 return -1.
+//
+// Low/high-pass: order 1..2*SOS_MAX_SECTIONS; an odd order leaves one first-order
+// section (b2 = a2 = 0). Band-pass/stop: 'order' is the digital order as for
+// init_bw_band_pass, even, up to 2*SOS_MAX_SECTIONS.
+//
+// Edge conventions:
+//   Chebyshev I, elliptic: f, fl, fu are passband edges, where the ripple 'rp' (dB) ends.
+//   Chebyshev II: f, fl, fu are stopband edges, where the attenuation 'rs' (dB) starts.
+//   Bessel: f, fl, fu are -3 dB points (order <= 8).
+// The passband peak gain is 1 (0 dB). Elliptic 4th order typically meets a
+// transition that needs 8th-order Butterworth, at half the cycles per sample.
+
+void init_cheby1_low_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rp);
+void init_cheby1_high_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rp);
+void init_cheby1_band_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rp);
+void init_cheby1_band_stop(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rp);
+
+void init_cheby2_low_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rs);
+void init_cheby2_high_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rs);
+void init_cheby2_band_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rs);
+void init_cheby2_band_stop(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rs);
+
+void init_bessel_low_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f);
+void init_bessel_high_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f);
+void init_bessel_band_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu);
+void init_bessel_band_stop(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu);
+
+void init_ellip_low_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rp, FTR_PRECISION rs);
+void init_ellip_high_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rp, FTR_PRECISION rs);
+void init_ellip_band_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rp, FTR_PRECISION rs);
+void init_ellip_band_stop(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rp, FTR_PRECISION rs);
+
+// Second-order notch: zeros on the unit circle at f, poles just inside, unity gain
+// at DC and Nyquist. q = f / (-3 dB width): q = 10 at 50 Hz is -3 dB at 47.5 and
+// 52.5 Hz and under 1 dB down outside 45..55 Hz. One biquad, half the work of a
+// 4th-order band-stop.
+void init_notch(SOSCascade* filter, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION q);
+// One notch per harmonic f, 2f, ... up to 'harmonics' sections (<= SOS_MAX_SECTIONS),
+// stopping below s/2. Every notch gets the width f/q of the fundamental.
+void init_notch_comb(SOSCascade* filter, FTR_PRECISION s, FTR_PRECISION f, int harmonics, FTR_PRECISION q);
+
+#if __cplusplus
+}
+#endif
+#endif
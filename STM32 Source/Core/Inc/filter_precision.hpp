@@ -0,0 +1,229 @@
+/* filter_precision.hpp - RUN-TIME BUTTERWORTH, TEMPLATED PRECISION, NO MALLOC
+ *
+ * The same designs as filter.h with the number format as a template parameter,
+ * so a double reference and the production format can run in one process:
+ *
+ *   bw::Cascade<double, 4>  ref;  ref.band_pass(1000, 45, 55);
+ *   bw::Cascade<bw::Q15, 4> fix;  fix.band_pass(1000, 45, 55);
+ *   double e = ref.process(x) - bw::Q15::to_double(fix.process(bw::Q15::from_double(x)));
+ *
+ * Sections is the biquad count (order/2). Coefficients are designed in double
+ * by filter.hpp and rounded once to the format. Needs C++14.
+ */
+#ifndef filter_precision_hpp
+#define filter_precision_hpp
+
+#include <stdint.h>
+#include "filter.hpp"
+#include "filter_q.h"
+
+namespace bw {
+
+// Fixed-point formats: Q1.x samples, Q2.x coefficients as in filter_q.h.
+template <class S, class C, class A, int Frac>
+struct FixedFormat {
+    typedef S sample;
+    typedef C coef;
+    typedef A acc;
+    static constexpr int frac = Frac;
+    static constexpr int sample_bits = 8 * sizeof(S) - 1;
+
+    static S from_double(double v) { return (S)clamp(v * (double)((A)1 << sample_bits)); }
+    static double to_double(S v) { return (double)v / (double)((A)1 << sample_bits); }
+    static C coef_from_double(double v) { return (C)clamp(v * (double)((A)1 << frac)); }
+
+private:
+    static A clamp(double v) {
+        const double hi = (double)(((A)1 << sample_bits) - 1), lo = -(double)((A)1 << sample_bits);
+        v += v < 0 ? -0.5 : 0.5;
+        return v >= hi ? (A)hi : v <= lo ? (A)lo : (A)v;
+    }
+};
+
+// 16x16 products into 32 bits; same arithmetic as sos_cascade_q15().
+struct Q15 : FixedFormat<q15_t, q15_t, int32_t, Q15_COEF_FRAC> {};
+// 32x32 products into 64 bits; same arithmetic as sos_cascade_q31().
+struct Q31 : FixedFormat<q31_t, q31_t, int64_t, Q31_COEF_FRAC> {};
+// Q31 samples with the Q63 accumulator's discarded fraction carried into the next
+// sample of the same section (error feedback). Cuts the rounding noise that high-Q
+// sections amplify (about 3x on the 45-55 Hz order-8 band-pass) for one add.
+struct Q63 : FixedFormat<q31_t, q31_t, int64_t, Q31_COEF_FRAC> {};
+
+namespace detail {
+
+template <class P>
+struct Format {
+    typedef P sample;
+    static P from_double(double v) { return (P)v; }
+    static double to_double(P v) { return (double)v; }
+};
+template <> struct Format<Q15> : Q15 {};
+template <> struct Format<Q31> : Q31 {};
+template <> struct Format<Q63> : Q63 {};
+
+// Shared design entry points; load() receives the design in double.
+template <class Derived, int N>
+class Designer {
+public:
+    void low_pass(double fs, double fc) { self().load(design_low_high<N, double>(fs, fc, false)); }
+    void high_pass(double fs, double fc) { self().load(design_low_high<N, double>(fs, fc, true)); }
+    void band_pass(double fs, double fl, double fu) {
+        static_assert(N % 2 == 0, "band designs need an even number of sections");
+        self().load(design_band<N, double>(fs, fl, fu, false));
+    }
+    void band_stop(double fs, double fl, double fu) {
+        static_assert(N % 2 == 0, "band designs need an even number of sections");
+        self().load(design_band<N, double>(fs, fl, fu, true));
+    }
+
+private:
+    Derived& self() { return static_cast<Derived&>(*this); }
+};
+
+// Floating point: Transposed Direct Form II, as sos_cascade_tdf2().
+template <class T, int N>
+class FloatCascade : public Designer<FloatCascade<T, N>, N> {
+public:
+    typedef T sample;
+
+    void load(const Sos<N, double>& d) {
+        for (int i = 0; i < N; ++i) {
+            b0_[i] = (T)d.b0[i]; b1_[i] = (T)d.b1[i]; b2_[i] = (T)d.b2[i];
+            a1_[i] = (T)d.a1[i]; a2_[i] = (T)d.a2[i];
+        }
+        reset();
+    }
+
+    void reset() {
+        for (int i = 0; i < N; ++i) { s1_[i] = 0; s2_[i] = 0; }
+    }
+
+    // Steady state for a constant input x, as sos_prime_tdf2().
+    void prime(T x) {
+        for (int i = 0; i < N; ++i) {
+            T y = (b0_[i] + b1_[i] + b2_[i]) * x / (1 + a1_[i] + a2_[i]);
+            s1_[i] = y - b0_[i] * x;
+            s2_[i] = b2_[i] * x - a2_[i] * y;
+            x = y;
+        }
+    }
+
+    T process(T x) {
+        for (int i = 0; i < N; ++i) {
+            T y = b0_[i] * x + s1_[i];
+            s1_[i] = b1_[i] * x + s2_[i] - a1_[i] * y;
+            s2_[i] = b2_[i] * x - a2_[i] * y;
+            x = y;
+        }
+        return x;
+    }
+
+    // Section-major like sos_cascade_tdf2_block(); 'in' and 'out' may alias.
+    void process(const T* in, T* out, int n) {
+        const T* src = in;
+        for (int i = 0; i < N; ++i) {
+            T b0 = b0_[i], b1 = b1_[i], b2 = b2_[i], a1 = a1_[i], a2 = a2_[i];
+            T s1 = s1_[i], s2 = s2_[i];
+            for (int k = 0; k < n; ++k) {
+                T x = src[k];
+                T y = b0 * x + s1;
+                s1 = b1 * x + s2 - a1 * y;
+                s2 = b2 * x - a2 * y;
+                out[k] = y;
+            }
+            s1_[i] = s1; s2_[i] = s2;
+            src = out;
+        }
+    }
+
+private:
+    T b0_[N] = {}, b1_[N] = {}, b2_[N] = {}, a1_[N] = {}, a2_[N] = {};
+    T s1_[N] = {}, s2_[N] = {};
+};
+
+// Fixed point: Direct Form I, so the state is bounded by the signal range.
+// Feedback selects the Q63 error-feedback variant.
+template <class F, int N, bool Feedback>
+class FixedCascade : public Designer<FixedCascade<F, N, Feedback>, N> {
+public:
+    typedef typename F::sample sample;
+    typedef typename F::coef coef;
+    typedef typename F::acc acc;
+
+    void load(const Sos<N, double>& d) {
+        for (int i = 0; i < N; ++i) {
+            b0_[i] = F::coef_from_double(d.b0[i]); b1_[i] = F::coef_from_double(d.b1[i]);
+            b2_[i] = F::coef_from_double(d.b2[i]);
+            a1_[i] = F::coef_from_double(d.a1[i]); a2_[i] = F::coef_from_double(d.a2[i]);
+        }
+        reset();
+    }
+
+    void reset() {
+        for (int i = 0; i < N; ++i) { x1_[i] = 0; x2_[i] = 0; y1_[i] = 0; y2_[i] = 0; e_[i] = 0; }
+    }
+
+    // Steady state for a constant input x, as sos_prime_q15()/sos_prime_q31().
+    void prime(sample x) {
+        for (int i = 0; i < N; ++i) {
+            int64_t num = ((int64_t)b0_[i] + b1_[i] + b2_[i]) * x;
+            int64_t den = ((int64_t)1 << F::frac) + a1_[i] + a2_[i];
+            sample y = saturate((acc)(num >= 0 ? (num + den / 2) / den : -((-num + den / 2) / den)));
+            x1_[i] = x; x2_[i] = x; y1_[i] = y; y2_[i] = y; e_[i] = 0;
+            x = y;
+        }
+    }
+
+    sample process(sample x) {
+        for (int i = 0; i < N; ++i) {
+            acc a = (acc)b0_[i] * x + (acc)b1_[i] * x1_[i] + (acc)b2_[i] * x2_[i]
+                  - (acc)a1_[i] * y1_[i] - (acc)a2_[i] * y2_[i];
+            sample y;
+            if (Feedback) {
+                a += e_[i];
+                acc q = a >> F::frac;
+                y = saturate(q);
+                e_[i] = (q == y) ? a - q * ((acc)1 << F::frac) : 0; // q < 0 half the time: no signed <<
+            } else {
+                y = saturate((a + ((acc)1 << (F::frac - 1))) >> F::frac);
+            }
+            x2_[i] = x1_[i]; x1_[i] = x;
+            y2_[i] = y1_[i]; y1_[i] = y;
+            x = y;
+        }
+        return x;
+    }
+
+    void process(const sample* in, sample* out, int n) {
+        for (int k = 0; k < n; ++k) out[k] = process(in[k]);
+    }
+
+private:
+    static sample saturate(acc v) {
+        const acc hi = ((acc)1 << F::sample_bits) - 1, lo = -((acc)1 << F::sample_bits);
+        return (sample)(v > hi ? hi : v < lo ? lo : v);
+    }
+
+    coef b0_[N] = {}, b1_[N] = {}, b2_[N] = {}, a1_[N] = {}, a2_[N] = {};
+    sample x1_[N] = {}, x2_[N] = {}, y1_[N] = {}, y2_[N] = {};
+    acc e_[N] = {};
+};
+
+template <class P, int N> struct Select { typedef FloatCascade<P, N> type; };
+template <int N> struct Select<Q15, N> { typedef FixedCascade<Q15, N, false> type; };
+template <int N> struct Select<Q31, N> { typedef FixedCascade<Q31, N, false> type; };
+template <int N> struct Select<Q63, N> { typedef FixedCascade<Q63, N, true> type; };
+
+} // namespace detail
+
+// P is float, double, Q15, Q31 or Q63; Sections is order/2.
+template <class P, int Sections>
+class Cascade : public detail::Select<P, Sections>::type {
+    static_assert(Sections >= 1, "need at least one section");
+public:
+    typedef detail::Format<P> format;
+};
+
+} // namespace bw
+
+#endif
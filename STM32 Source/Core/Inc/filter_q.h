@@ -0,0 +1,149 @@
+/* filter_q.h - FIXED POINT (Q15/Q31) VERSION, NO MALLOC */
+#ifndef filter_q_h
+#define filter_q_h
+
+#include <stdint.h>
+#include "filter.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+// Coefficient formats (fractional bits). Every biquad coefficient lies in
+// (-Q_COEF_LIMIT, Q_COEF_LIMIT), and |b0|+|b1|+|b2|+|a1|+|a2| < Q_SUM_LIMIT per
+// section keeps the Q15 sums within 32 bits and the Q31 sums within 64 bits.
+#define Q15_COEF_FRAC       13  // Q2.13
+#define Q31_COEF_FRAC       29  // Q2.29
+#define Q_COEF_LIMIT        4.0f
+#define Q_SUM_LIMIT         8.0f
+
+static inline q15_t q15_sat(int32_t x) {
+    if (x > INT16_MAX) return INT16_MAX;
+    if (x < INT16_MIN) return INT16_MIN;
+    return (q15_t)x;
+}
+
+static inline q31_t q31_sat(int64_t x) {
+    if (x > INT32_MAX) return INT32_MAX;
+    if (x < INT32_MIN) return INT32_MIN;
+    return (q31_t)x;
+}
+
+// Q15 sine from the shared quarter-wave table; phase 2^32 = one full turn.
+q15_t ftr_sin_q15(uint32_t phase);
+
+// Direct Form I: the state is the section's own input/output history, which is
+// bounded by the signal range, so nothing inside the cascade needs headroom.
+// Each section gain A is replaced by a shift 2^-k <= A (numerator built from adds
+// and one shift), and the leftover G = prod(A*2^k) is applied once at the output.
+// G < 2^MAX_SECTIONS, so the Q2.x gain format covers MAX_SECTIONS <= 2.
+typedef struct {
+    int n;
+    q15_t G;
+    uint8_t sh[MAX_SECTIONS];
+    q15_t d1[MAX_SECTIONS];
+    q15_t d2[MAX_SECTIONS];
+    q15_t x1[MAX_SECTIONS];
+    q15_t x2[MAX_SECTIONS];
+    q15_t y1[MAX_SECTIONS];
+    q15_t y2[MAX_SECTIONS];
+} BWLowPassQ15;
+typedef BWLowPassQ15 BWHighPassQ15;
+
+typedef struct {
+    int n;
+    q31_t G;
+    uint8_t sh[MAX_SECTIONS];
+    q31_t d1[MAX_SECTIONS];
+    q31_t d2[MAX_SECTIONS];
+    q31_t x1[MAX_SECTIONS];
+    q31_t x2[MAX_SECTIONS];
+    q31_t y1[MAX_SECTIONS];
+    q31_t y2[MAX_SECTIONS];
+} BWLowPassQ31;
+typedef BWLowPassQ31 BWHighPassQ31;
+
+// Quantized SOSCascade, Direct Form I per biquad. |b0|+|b1|+|b2|+|a1|+|a2| <= 7
+// for every Butterworth section, inside the Q_SUM_LIMIT the kernels need.
+typedef struct {
+    int n;
+    q15_t b0[SOS_MAX_SECTIONS];
+    q15_t b1[SOS_MAX_SECTIONS];
+    q15_t b2[SOS_MAX_SECTIONS];
+    q15_t a1[SOS_MAX_SECTIONS];
+    q15_t a2[SOS_MAX_SECTIONS];
+    q15_t x1[SOS_MAX_SECTIONS];
+    q15_t x2[SOS_MAX_SECTIONS];
+    q15_t y1[SOS_MAX_SECTIONS];
+    q15_t y2[SOS_MAX_SECTIONS];
+} SOSCascadeQ15;
+
+typedef struct {
+    int n;
+    q31_t b0[SOS_MAX_SECTIONS];
+    q31_t b1[SOS_MAX_SECTIONS];
+    q31_t b2[SOS_MAX_SECTIONS];
+    q31_t a1[SOS_MAX_SECTIONS];
+    q31_t a2[SOS_MAX_SECTIONS];
+    q31_t x1[SOS_MAX_SECTIONS];
+    q31_t x2[SOS_MAX_SECTIONS];
+    q31_t y1[SOS_MAX_SECTIONS];
+    q31_t y2[SOS_MAX_SECTIONS];
+} SOSCascadeQ31;
+
+// Band types are factored into biquads like their float counterparts.
+typedef SOSCascadeQ15 BWBandPassQ15;
+typedef SOSCascadeQ15 BWBandStopQ15;
+typedef SOSCascadeQ31 BWBandPassQ31;
+typedef SOSCascadeQ31 BWBandStopQ31;
+
+// Same arguments as the float designers; the float design is quantized once.
+// sos_quantize_* return 0, or -1 with filter->n = 0 (a pass-through) when a section
+// breaks the coefficient limits above instead of clamping it into a different filter.
+int sos_quantize_q15(SOSCascadeQ15* filter, const SOSCascade* ref);
+int sos_quantize_q31(SOSCascadeQ31* filter, const SOSCascade* ref);
+
+void init_bw_low_pass_q15(BWLowPassQ15* filter, int order, FTR_PRECISION s, FTR_PRECISION f);
+void init_bw_high_pass_q15(BWHighPassQ15* filter, int order, FTR_PRECISION s, FTR_PRECISION f);
+void init_bw_band_pass_q15(BWBandPassQ15* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu);
+void init_bw_band_stop_q15(BWBandStopQ15* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu);
+
+void init_bw_low_pass_q31(BWLowPassQ31* filter, int order, FTR_PRECISION s, FTR_PRECISION f);
+void init_bw_high_pass_q31(BWHighPassQ31* filter, int order, FTR_PRECISION s, FTR_PRECISION f);
+void init_bw_band_pass_q31(BWBandPassQ31* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu);
+void init_bw_band_stop_q31(BWBandStopQ31* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu);
+
+// Steady-state priming from a constant input x, as bw_*_prime() in filter.h.
+void sos_prime_q15(SOSCascadeQ15* filter, q15_t x);
+void bw_low_pass_prime_q15(BWLowPassQ15* filter, q15_t x);
+void bw_high_pass_prime_q15(BWHighPassQ15* filter, q15_t x);
+void bw_band_pass_prime_q15(BWBandPassQ15* filter, q15_t x);
+void bw_band_stop_prime_q15(BWBandStopQ15* filter, q15_t x);
+
+void sos_prime_q31(SOSCascadeQ31* filter, q31_t x);
+void bw_low_pass_prime_q31(BWLowPassQ31* filter, q31_t x);
+void bw_high_pass_prime_q31(BWHighPassQ31* filter, q31_t x);
+void bw_band_pass_prime_q31(BWBandPassQ31* filter, q31_t x);
+void bw_band_stop_prime_q31(BWBandStopQ31* filter, q31_t x);
+
+// Q15: 16x16 products into a 32-bit accumulator.
+q15_t sos_cascade_q15(SOSCascadeQ15* filter, q15_t input);
+q15_t bw_low_pass_q15(BWLowPassQ15* filter, q15_t input);
+q15_t bw_high_pass_q15(BWHighPassQ15* filter, q15_t input);
+q15_t bw_band_pass_q15(BWBandPassQ15* filter, q15_t input);
+q15_t bw_band_stop_q15(BWBandStopQ15* filter, q15_t input);
+
+// Q31: 32x32 products into a 64-bit accumulator. Use for low fc/fs ratios.
+q31_t sos_cascade_q31(SOSCascadeQ31* filter, q31_t input);
+q31_t bw_low_pass_q31(BWLowPassQ31* filter, q31_t input);
+q31_t bw_high_pass_q31(BWHighPassQ31* filter, q31_t input);
+q31_t bw_band_pass_q31(BWBandPassQ31* filter, q31_t input);
+q31_t bw_band_stop_q31(BWBandStopQ31* filter, q31_t input);
+
+#if __cplusplus
+}
+#endif
+#endif
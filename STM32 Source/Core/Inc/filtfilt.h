@@ -0,0 +1,36 @@
+/* filtfilt.h - ZERO-PHASE FORWARD-BACKWARD FILTERING, NO MALLOC */
+#ifndef filtfilt_h
+#define filtfilt_h
+
+#include "filter.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+// Edge padding: 3*(order+1) samples of odd reflection about each end point, as
+// commonly used for forward-backward IIR filtering.
+#define FILTFILT_MAX_PAD    (3 * (2 * SOS_MAX_SECTIONS + 1))
+// Samples per backward-pass step; the only buffer besides the padding.
+#define FILTFILT_CHUNK      256
+
+// Zero-phase filtering with the magnitude response squared. 'design' is any
+// designed cascade (init_bw_*_sos, init_bw_band_pass, ...) and is not modified.
+// Both passes start from the steady state for their first padded sample, so
+// the ends carry no start-up transient. Streams through 'in' and 'out' front to back
+// and back to front in FILTFILT_CHUNK steps; 'out' may be 'in', so a
+// memory-mapped buffer is filtered in place without extra copies.
+// Returns 0, or -1 if n < 2.
+int sos_filtfilt(const SOSCascade* design, const FTR_PRECISION* in, FTR_PRECISION* out, long n);
+
+#if defined(__unix__) || defined(__APPLE__)
+// Host only: filters a raw native-endian float32 mono file into 'out_path' through
+// shared memory mappings, so multi-gigabyte captures run in bounded memory.
+// Returns 0, or -1 on I/O errors.
+int sos_filtfilt_file(const SOSCascade* design, const char* in_path, const char* out_path);
+#endif
+
+#if __cplusplus
+}
+#endif
+#endif
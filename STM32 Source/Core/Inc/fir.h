@@ -0,0 +1,64 @@
+/* fir.h - LINEAR-PHASE FIR, NO MALLOC */
+#ifndef fir_h
+#define fir_h
+
+#include "filter.h"
+#include "filter_q.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+// History length, a power of two. The history is stored twice (hist[i] and
+// hist[i + FIR_MAX_TAPS] hold the same sample), so the newest 'taps' samples are
+// always contiguous at hist + pos: the dot product runs without modulo or wrap
+// checks, and the write index wraps with a mask.
+#ifndef FIR_MAX_TAPS
+#define FIR_MAX_TAPS 32
+#endif
+
+#if (FIR_MAX_TAPS & (FIR_MAX_TAPS - 1)) != 0
+#error "FIR_MAX_TAPS must be a power of two"
+#endif
+
+// 'symmetric' is set when h[k] == h[taps-1-k]; the kernel then adds the mirrored
+// samples first and does taps/2 (+1) multiplies instead of 'taps'.
+typedef struct {
+    int taps;
+    int pos;
+    int symmetric;
+    FTR_PRECISION h[FIR_MAX_TAPS];
+    FTR_PRECISION hist[2 * FIR_MAX_TAPS];
+} FIRFilter;
+
+// Q1.15 coefficients and samples; 32-bit products summed in 64 bits.
+typedef struct {
+    int taps;
+    int pos;
+    int symmetric;
+    q15_t h[FIR_MAX_TAPS];
+    q15_t hist[2 * FIR_MAX_TAPS];
+} FIRFilterQ15;
+
+// Loads 'taps' (<= FIR_MAX_TAPS) coefficients and clears the history.
+void init_fir(FIRFilter* filter, const FTR_PRECISION* h, int taps);
+// Windowed-sinc (Hamming) designs with unity gain at DC, Nyquist or the band
+// centre. High-pass rounds 'taps' up to odd; all designs are exactly symmetric.
+void init_fir_low_pass(FIRFilter* filter, int taps, FTR_PRECISION s, FTR_PRECISION f);
+void init_fir_high_pass(FIRFilter* filter, int taps, FTR_PRECISION s, FTR_PRECISION f);
+void init_fir_band_pass(FIRFilter* filter, int taps, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu);
+void fir_reset(FIRFilter* filter);
+void fir_quantize_q15(FIRFilterQ15* filter, const FIRFilter* ref);
+void fir_reset_q15(FIRFilterQ15* filter);
+
+FTR_PRECISION fir_filter(FIRFilter* filter, FTR_PRECISION input);
+q15_t fir_filter_q15(FIRFilterQ15* filter, q15_t input);
+
+// 'in' and 'out' may point to the same buffer.
+void fir_filter_block(FIRFilter* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n);
+void fir_filter_block_q15(FIRFilterQ15* filter, const q15_t* in, q15_t* out, int n);
+
+#if __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,55 @@
+/* goertzel.h - FIXED POINT GOERTZEL TONE BANK, NO MALLOC */
+#ifndef goertzel_h
+#define goertzel_h
+
+#include <stdint.h>
+#include "filter.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+#define GOERTZEL_MAX_TONES  8
+// Resonator state grows to about window^2 * |x| / (4 pi) at the lowest bin, so
+// inputs within +-2^11 (centred 12-bit codes) and windows up to 2048 fit int32.
+#define GOERTZEL_MAX_WINDOW 2048
+// 2cos(w) in Q2.29: near w = 0 its slope is 2 sin(w), so a coarser coefficient
+// moves a 0.5 Hz tone at 1 kHz by whole bins.
+#define GOERTZEL_COEF_FRAC  29
+
+// One second-order resonator per tone, s = x + 2cos(w) s1 - s2 with 32x32 -> 64-bit
+// products. At the end of each frame the tone amplitude,
+// 2 |X| / window, goes to amp[] in input units.
+//
+// hop >= window: blocked frames, the resonators run as samples arrive.
+// hop <  window: sliding frames, every 'hop' samples the bank reruns over the last
+//                'window' inputs kept in caller-provided history (window entries),
+//                window * tones multiplies per hop.
+typedef struct {
+    int tones;
+    int window;
+    int hop;
+    int count;
+    int pos;
+    int16_t* history;
+    int32_t coef[GOERTZEL_MAX_TONES];
+    int32_t s1[GOERTZEL_MAX_TONES];
+    int32_t s2[GOERTZEL_MAX_TONES];
+    uint16_t amp[GOERTZEL_MAX_TONES];
+} GoertzelBank;
+
+// 'freqs' in the units of 's' (any frequency, not only bin centres); 'tones' is
+// clamped to GOERTZEL_MAX_TONES, 'window' to 1..GOERTZEL_MAX_WINDOW. 'history' may
+// be NULL for blocked frames.
+void init_goertzel(GoertzelBank* g, FTR_PRECISION s, const FTR_PRECISION* freqs, int tones, int window, int hop, int16_t* history);
+void goertzel_reset(GoertzelBank* g);
+
+// Feeds one sample; returns 1 when a frame completed and amp[] was updated.
+int goertzel_update(GoertzelBank* g, int16_t x);
+// Returns the number of frames completed; amp[] holds the last one.
+int goertzel_update_block(GoertzelBank* g, const int16_t* in, int n);
+
+#if __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,70 @@
+/* level.h - INTEGER ENVELOPE, RMS AND PEAK DETECTORS, NO MALLOC */
+#ifndef level_h
+#define level_h
+
+#include <stdint.h>
+#include "filter.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+// Inputs are signed samples centred on 0, within +-2^11 for the RMS window sums
+// (12-bit codes minus mid-scale, e.g. a bw_* output minus 2048). Outputs are in
+// the same units. State carries 16 fractional bits, so shifts leave no residue.
+
+#define RMS_MAX_LOG2    7   // window up to 128 samples
+
+// One-pole follower of |x|: rises with time constant 2^attack samples and falls
+// with 2^release samples (a shift and an add each).
+typedef struct {
+    uint8_t attack;
+    uint8_t release;
+    uint32_t env;
+} EnvelopeFollower;
+
+// Running sum of squares over a power-of-two window: add the new square, subtract
+// the one leaving. The square root is only taken when the value is read.
+typedef struct {
+    uint8_t shift;
+    uint8_t pos;
+    uint32_t sum;
+    int16_t buf[1 << RMS_MAX_LOG2];
+} RMSMeter;
+
+// Holds the largest |x| for 'hold' samples, then decays by 2^-decay per sample.
+typedef struct {
+    uint16_t hold;
+    uint16_t count;
+    uint8_t decay;
+    uint32_t peak;
+} PeakHold;
+
+// Times in seconds at sample rate s; each is rounded to the nearest power-of-two
+// number of samples (1 to 2^15).
+void init_envelope(EnvelopeFollower* e, FTR_PRECISION s, FTR_PRECISION attack, FTR_PRECISION release);
+// 'len' is rounded down to a power of two, 1..2^RMS_MAX_LOG2.
+void init_rms(RMSMeter* r, int len);
+void init_peak_hold(PeakHold* p, FTR_PRECISION s, FTR_PRECISION hold, FTR_PRECISION decay);
+
+void envelope_reset(EnvelopeFollower* e);
+void rms_reset(RMSMeter* r);
+void peak_hold_reset(PeakHold* p);
+// Steady state for a constant input x, as the bw_*_prime() functions.
+void envelope_prime(EnvelopeFollower* e, int16_t x);
+void peak_hold_prime(PeakHold* p, int16_t x);
+
+uint16_t envelope(EnvelopeFollower* e, int16_t x);
+void rms_update(RMSMeter* r, int16_t x);
+uint16_t rms_value(const RMSMeter* r);
+uint16_t peak_hold(PeakHold* p, int16_t x);
+
+// Each returns the value after the last sample.
+uint16_t envelope_block(EnvelopeFollower* e, const int16_t* in, int n);
+uint16_t rms_block(RMSMeter* r, const int16_t* in, int n);
+uint16_t peak_hold_block(PeakHold* p, const int16_t* in, int n);
+
+#if __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,72 @@
+/* nlms.h - FIXED POINT NLMS INTERFERENCE CANCELLER, NO MALLOC */
+#ifndef nlms_h
+#define nlms_h
+
+#include <stdint.h>
+#include "filter_q.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+// Reference history length, a power of two, mirrored as in fir.h.
+#ifndef NLMS_MAX_TAPS
+#define NLMS_MAX_TAPS 16
+#endif
+
+#if (NLMS_MAX_TAPS & (NLMS_MAX_TAPS - 1)) != 0
+#error "NLMS_MAX_TAPS must be a power of two"
+#endif
+
+// Weights are Q4.27 (|w| < 16, so a reference weaker than the interference still
+// cancels); the filter uses their top 16 bits (Q4.11) with 32-bit products into a
+// 64-bit sum, as fir_filter_q15(). Adding epsilon to the reference energy bounds
+// the normalized step while the reference is silent.
+#define NLMS_WEIGHT_FRAC    27
+#define NLMS_EPSILON        (1 << 20)   // Q30 energy, about 1e-3
+
+// Estimates the interference in d[n] from the newest 'taps' reference samples and
+// returns the error e = d - estimate, which is the cleaned signal. Every sample adds
+// e * ref to a gradient sum; every 'interval' samples the weights move by
+// mu * mean / (|ref|^2 + eps) (block NLMS; 'interval' 1 is plain NLMS). The
+// energy, the 64-bit division and the weight writes are paid once per block, which
+// is what dominates on the M0+; adaptation is 'interval' times slower for the
+// same mu.
+typedef struct {
+    int taps;
+    int pos;
+    int interval;
+    int count;
+    q15_t mu;
+    int32_t w[NLMS_MAX_TAPS];
+    int32_t grad[NLMS_MAX_TAPS];
+    q15_t ref[2 * NLMS_MAX_TAPS];
+} NLMSCanceller;
+
+// Reference oscillator: phase accumulator into ftr_sin_q15 (2^32 = one turn).
+typedef struct {
+    uint32_t phase;
+    uint32_t step;
+} NLMSOscillator;
+
+// mu in (0, 1) as Q15; larger mu follows drift faster but notches a wider band of
+// the wanted signal (0.1 tracks 0.3 Hz of mains drift to about -20 dB). 'taps' is
+// clamped to 1..NLMS_MAX_TAPS, 'interval' to 1..16 so the gradient sum fits 32 bits.
+void init_nlms(NLMSCanceller* c, int taps, q15_t mu, int interval);
+void nlms_reset(NLMSCanceller* c);
+
+q15_t nlms_cancel_q15(NLMSCanceller* c, q15_t d, q15_t ref);
+// 'in' and 'out' may point to the same buffer.
+void nlms_cancel_block_q15(NLMSCanceller* c, const q15_t* in, const q15_t* ref, q15_t* out, int n);
+
+// Synthesized reference at f for sample rate s, for interference at a known
+// nominal frequency (mains). Two or more taps let the weights follow its phase,
+// amplitude and slow frequency drift.
+void init_nlms_oscillator(NLMSOscillator* osc, FTR_PRECISION s, FTR_PRECISION f);
+q15_t nlms_oscillator_next(NLMSOscillator* osc);
+void nlms_oscillator_block(NLMSOscillator* osc, q15_t* out, int n);
+
+#if __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,78 @@
+/* pipeline.h - RUN-TIME CONFIGURABLE CHAIN OF FILTER STAGES, NO MALLOC */
+#ifndef pipeline_h
+#define pipeline_h
+
+#include <stdint.h>
+#include "filter.h"
+#include "level.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+// An ordered list of stages run block by block: each stage takes the whole block
+// in place before the next one starts, so the type dispatch and the state loads
+// happen once per stage per block, not once per sample. Samples are float and
+// centred on 0 (ADC code - 2048). Decimators shorten the block for the stages
+// after them, which are designed at the reduced rate.
+#define PIPE_MAX_STAGES 4
+#define PIPE_BLOCK      16
+
+enum {
+    PIPE_DC_BLOCK,      // y = x - x1 + (1 - 2^-k) y1
+    PIPE_NOTCH,         // init_notch()
+    PIPE_LOW_PASS,      // Butterworth, as biquads
+    PIPE_HIGH_PASS,
+    PIPE_BAND_PASS,
+    PIPE_BAND_STOP,
+    PIPE_DECIMATE,      // mean of every m samples
+    PIPE_ENVELOPE,      // EnvelopeFollower
+    PIPE_PEAK,          // PeakHold
+};
+
+typedef struct {
+    uint8_t type;
+    union {
+        SOSCascade sos;
+        struct { FTR_PRECISION r, x1, y1; } dc;
+        struct { uint8_t m, count; FTR_PRECISION inv, sum; } dec;
+        EnvelopeFollower env;
+        PeakHold peak;
+    } u;
+} PipeStage;
+
+typedef struct {
+    int n;
+    uint8_t primed;     // 0: load the steady state from the first sample of the next block
+    FTR_PRECISION s;    // input rate
+    FTR_PRECISION rate; // rate after the last stage
+    PipeStage stage[PIPE_MAX_STAGES];
+} Pipeline;
+
+// Empty chain (pass-through) at input rate s.
+void init_pipeline(Pipeline* p, FTR_PRECISION s);
+// Appends one stage designed at the current output rate. Arguments by type:
+//   DC_BLOCK k | NOTCH f, q | LOW/HIGH_PASS f, order | BAND_PASS/STOP fl, fu, order
+//   DECIMATE m | ENVELOPE attack, release (s) | PEAK hold, decay (s)
+// Returns the stage count, or -1 (chain unchanged) when full or out of range.
+int pipeline_add(Pipeline* p, uint8_t type, const FTR_PRECISION* arg);
+// Replaces the chain from text such as "n50,l15/4,d4": comma-separated stages, a
+// letter then '/'-separated numbers, omitted trailing numbers take the defaults.
+//   c[k=6]  n<f>[/q=10]  l<f>[/order=4]  h<f>[/order=4]  b<fl>/<fu>[/order=4]
+//   s<fl>/<fu>[/order=4]  d<m>  e[attack=4/release=128 ms]  k[hold=500/decay=250 ms]
+// Returns the stage count, or -1 leaving the chain unchanged on any error. A chain
+// with the same stage types and sizes as the running one only changes parameters:
+// the stage states carry over instead of being primed again.
+int pipeline_parse(Pipeline* p, const char* text);
+// Clears the stage states; the next block starts from its steady state.
+void pipeline_reset(Pipeline* p);
+void pipeline_prime(Pipeline* p, FTR_PRECISION x);
+
+// Runs the chain over buf[0..n-1] in place; returns the number of outputs at the
+// front of buf (fewer than n after a decimator).
+int pipeline_run(Pipeline* p, FTR_PRECISION* buf, int n);
+
+#if __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,78 @@
+/* resample.h - POLYPHASE RATIONAL RESAMPLER, NO MALLOC */
+#ifndef resample_h
+#define resample_h
+
+#include "filter.h"
+#include "filter_q.h"
+
+#if __cplusplus
+extern "C"{
+#endif
+
+// Output rate = input rate * L / M. The anti-imaging/anti-aliasing low-pass runs at
+// L times the input rate and is split into L branches of 'taps' coefficients; each
+// output takes one branch over the newest 'taps' inputs, so the zero-stuffed and
+// discarded samples are never computed.
+//
+// History length per branch, a power of two, mirrored as in fir.h.
+#ifndef RESAMPLE_MAX_TAPS
+#define RESAMPLE_MAX_TAPS   32
+#endif
+// Total coefficients, L * taps.
+#ifndef RESAMPLE_MAX_COEFS
+#define RESAMPLE_MAX_COEFS  64
+#endif
+
+#if (RESAMPLE_MAX_TAPS & (RESAMPLE_MAX_TAPS - 1)) != 0
+#error "RESAMPLE_MAX_TAPS must be a power of two"
+#endif
+
+typedef struct {
+    int L;
+    int M;
+    int taps;
+    int phase;  // position of the next output between the newest two inputs, in 1/L steps
+    int pos;
+    FTR_PRECISION h[RESAMPLE_MAX_COEFS];  // branch p at h + p * taps
+    FTR_PRECISION hist[2 * RESAMPLE_MAX_TAPS];
+} Resampler;
+
+// Q1.15 coefficients and samples; 32-bit products summed in 64 bits.
+typedef struct {
+    int L;
+    int M;
+    int taps;
+    int phase;
+    int pos;
+    q15_t h[RESAMPLE_MAX_COEFS];
+    q15_t hist[2 * RESAMPLE_MAX_TAPS];
+} ResamplerQ15;
+
+// L/M is reduced by its gcd; a reduced L above RESAMPLE_MAX_COEFS returns -1 and
+// leaves a 1:1 pass-through, otherwise 0. 'taps' per branch is clamped to
+// RESAMPLE_MAX_TAPS and RESAMPLE_MAX_COEFS / L. The Hamming-windowed sinc cuts off at 0.45 of the lower of
+// the two rates, and every branch is scaled to unity DC gain. The transition band is
+// about 3.3 * max(L, M) / (L * taps) of the input rate wide: 32 taps for 1 kHz -> 500 Hz
+// put it at 225 +- 50 Hz.
+// e.g. 1 kHz -> 250 Hz: init_resampler(&r, 250, 1000, 32).
+int init_resampler(Resampler* r, int L, int M, int taps);
+void resampler_reset(Resampler* r);
+void resampler_quantize_q15(ResamplerQ15* r, const Resampler* ref);
+void resampler_reset_q15(ResamplerQ15* r);
+
+// Upper bound of the outputs one input can produce.
+#define RESAMPLE_MAX_OUT(r) (((r)->L + (r)->M - 1) / (r)->M)
+
+// Feeds one input sample; writes 0..RESAMPLE_MAX_OUT outputs and returns how many.
+int resample(Resampler* r, FTR_PRECISION x, FTR_PRECISION* out);
+int resample_q15(ResamplerQ15* r, q15_t x, q15_t* out);
+
+// Returns the number of outputs written, at most (n * L + M - 1) / M + 1.
+// 'in' and 'out' must not overlap.
+int resample_block(Resampler* r, const FTR_PRECISION* in, int n, FTR_PRECISION* out);
+int resample_block_q15(ResamplerQ15* r, const q15_t* in, int n, q15_t* out);
+
+#if __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,93 @@
+#include "adc_filters.h"
+
+// --- Moving average ---
+
+void moving_average_prime(MovingAverage* ma, uint16_t x) {
+    int len = 1 << ma->shift;
+    ma->pos = 0;
+    ma->sum = (uint32_t)x << ma->shift;
+    for(int i=0; i<len; i++) ma->buf[i] = x;
+}
+
+void init_moving_average(MovingAverage* ma, int len) {
+    uint8_t shift = 0;
+    while(shift < MA_MAX_LOG2 && (2 << shift) <= len) shift++;
+    ma->shift = shift;
+    moving_average_prime(ma, 0);
+}
+
+uint16_t moving_average(MovingAverage* ma, uint16_t x){
+    int pos = ma->pos;
+    ma->sum += (uint32_t)x - ma->buf[pos];
+    ma->buf[pos] = x;
+    ma->pos = (uint8_t)((pos + 1) & ((1 << ma->shift) - 1));
+    return (uint16_t)((ma->sum + ((1u << ma->shift) >> 1)) >> ma->shift);
+}
+
+// --- Median ---
+
+void median_prime(MedianFilter* m, uint16_t x) {
+    m->pos = 0;
+    for(int i=0; i<m->len; i++) { m->ring[i] = x; m->sorted[i] = x; }
+}
+
+void init_median(MedianFilter* m, int len) {
+    if(len < 1) len = 1;
+    if(len > MEDIAN_MAX_LEN) len = MEDIAN_MAX_LEN;
+    m->len = (uint8_t)(len | 1);
+    median_prime(m, 0);
+}
+
+uint16_t median_filter(MedianFilter* m, uint16_t x){
+    int n = m->len;
+    uint16_t old = m->ring[m->pos];
+    m->ring[m->pos] = x;
+    if(++m->pos == n) m->pos = 0;
+
+    // Find the outgoing value, then slide neighbours into its slot until x fits.
+    uint16_t* s = m->sorted;
+    int i = 0;
+    while(s[i] != old) i++;
+    if(x > old){
+        while(i + 1 < n && s[i + 1] < x) { s[i] = s[i + 1]; i++; }
+    } else {
+        while(i > 0 && s[i - 1] > x) { s[i] = s[i - 1]; i--; }
+    }
+    s[i] = x;
+    return s[n >> 1];
+}
+
+// --- DC blocker ---
+
+void dc_blocker_prime(DCBlocker* d, uint16_t x) {
+    d->x1 = x;
+    d->acc = 0;
+}
+
+void init_dc_blocker(DCBlocker* d, int k) {
+    if(k < 1) k = 1;
+    if(k > 15) k = 15;
+    d->k = (uint8_t)k;
+    dc_blocker_prime(d, 0);
+}
+
+// |acc| < 2^16 * 2^15 for 14-bit codes, so int32 holds it.
+int16_t dc_blocker(DCBlocker* d, uint16_t x){
+    int32_t acc = d->acc;
+    acc += ((int32_t)x - d->x1) * 65536 - (acc >> d->k);
+    d->acc = acc;
+    d->x1 = x;
+    return (int16_t)((acc + 32768) >> 16);
+}
+
+void moving_average_block(MovingAverage* ma, const uint16_t* in, uint16_t* out, int n){
+    for(int k=0; k<n; k++) out[k] = moving_average(ma, in[k]);
+}
+
+void median_filter_block(MedianFilter* m, const uint16_t* in, uint16_t* out, int n){
+    for(int k=0; k<n; k++) out[k] = median_filter(m, in[k]);
+}
+
+void dc_blocker_block(DCBlocker* d, const uint16_t* in, int16_t* out, int n){
+    for(int k=0; k<n; k++) out[k] = dc_blocker(d, in[k]);
+}
@@ -0,0 +1,105 @@
+#include "cic.h"
+
+#define CIC_COMP_STEPS 32
+
+uint32_t cic_gain(const CICDecimator* cic) {
+    uint32_t g = 1;
+    for(int i=0; i<cic->order; i++) g *= (uint32_t)cic->rate;
+    return g;
+}
+
+void cic_reset(CICDecimator* cic) {
+    cic->count = 0;
+    for(int i=0; i<CIC_MAX_ORDER; i++) { cic->integ[i] = 0; cic->comb[i] = 0; }
+}
+
+void init_cic(CICDecimator* cic, int order, int rate) {
+    if(order < 1) order = 1;
+    if(order > CIC_MAX_ORDER) order = CIC_MAX_ORDER;
+    if(rate < 1) rate = 1;
+    for(;;){
+        uint64_t g = 1;
+        for(int i=0; i<order; i++) g *= (uint64_t)rate;
+        if(g <= (1ULL << (32 - CIC_INPUT_BITS)) || rate == 1) break;
+        rate--;
+    }
+    cic->order = order;
+    cic->rate = rate;
+    cic_reset(cic);
+}
+
+int cic_decimate(CICDecimator* cic, uint16_t x, uint32_t* out) {
+    uint32_t v = x;
+    for(int i=0; i<cic->order; i++) { cic->integ[i] += v; v = cic->integ[i]; }
+    if(++cic->count < cic->rate) return 0;
+    cic->count = 0;
+    for(int i=0; i<cic->order; i++) { uint32_t t = v; v -= cic->comb[i]; cic->comb[i] = t; }
+    *out = v;
+    return 1;
+}
+
+int cic_decimate_block(CICDecimator* cic, const uint16_t* in, int n, uint32_t* out) {
+    int m = 0;
+    for(int k=0; k<n; k++) m += cic_decimate(cic, in[k], out + m);
+    return m;
+}
+
+// |H(v)| / gain at v cycles per output sample: |sin(pi v) / (R sin(pi v / R))|^N.
+static FTR_PRECISION cic_droop(const CICDecimator* cic, FTR_PRECISION v) {
+    if(v <= 0.0f) return 1.0f;
+    FTR_PRECISION r = ftr_sin(M_PI * v) / ((FTR_PRECISION)cic->rate * ftr_sin(M_PI * v / (FTR_PRECISION)cic->rate));
+    if(r < 0) r = -r;
+    FTR_PRECISION d = 1.0f;
+    for(int i=0; i<cic->order; i++) d *= r;
+    return d;
+}
+
+// Least-squares fit of the zero-phase response A(v) = c0 + 2*sum(c_m cos(2 pi v m)) to
+// 1/droop(v) on CIC_COMP_STEPS points of [0, cutoff]; above cutoff the response is
+// left free, which a short filter needs to reach the target. The normal equations
+// (at most CIC_COMP_MAX_TAPS/2 + 1 unknowns) get a small ridge term and are solved
+// by Gaussian elimination. Init time only.
+void init_cic_compensator(FIRFilter* fir, const CICDecimator* cic, int taps, FTR_PRECISION cutoff) {
+    enum { MAX_TAPS = (CIC_COMP_MAX_TAPS < FIR_MAX_TAPS - 1) ? CIC_COMP_MAX_TAPS : FIR_MAX_TAPS - 1,
+           MAX_C = MAX_TAPS / 2 + 1 };
+    FTR_PRECISION M[MAX_C][MAX_C + 1] = { { 0 } }, h[MAX_TAPS | 1], basis[MAX_C];
+    if(taps < 1) taps = 1;
+    if(taps > MAX_TAPS) taps = MAX_TAPS;
+    taps |= 1;  // odd length: a centre tap plus symmetric pairs
+    if(taps > MAX_TAPS) taps -= 2;
+    int nc = taps / 2 + 1;
+
+    for(int j=0; j<CIC_COMP_STEPS; j++){
+        FTR_PRECISION v = cutoff * (FTR_PRECISION)j / (CIC_COMP_STEPS - 1);
+        FTR_PRECISION target = 1.0f / cic_droop(cic, v);
+        basis[0] = 1.0f;
+        for(int m=1; m<nc; m++) basis[m] = 2.0f * ftr_cos(2.0f * M_PI * v * (FTR_PRECISION)m);
+        for(int r=0; r<nc; r++){
+            for(int c=0; c<nc; c++) M[r][c] += basis[r] * basis[c];
+            M[r][nc] += basis[r] * target;
+        }
+    }
+    for(int r=0; r<nc; r++) M[r][r] += 1e-4f;
+
+    for(int r=0; r<nc; r++){
+        int piv = r;
+        for(int q=r+1; q<nc; q++) if((M[q][r] < 0 ? -M[q][r] : M[q][r]) > (M[piv][r] < 0 ? -M[piv][r] : M[piv][r])) piv = q;
+        for(int c=0; c<=nc; c++) { FTR_PRECISION t = M[r][c]; M[r][c] = M[piv][c]; M[piv][c] = t; }
+        for(int q=0; q<nc; q++){
+            if(q == r) continue;
+            FTR_PRECISION f = M[q][r] / M[r][r];
+            for(int c=r; c<=nc; c++) M[q][c] -= f * M[r][c];
+        }
+    }
+
+    // Unit DC gain after the fit, then divide out rate^order.
+    FTR_PRECISION dc = 0;
+    for(int m=0; m<nc; m++) dc += (m ? 2.0f : 1.0f) * M[m][nc] / M[m][m];
+    FTR_PRECISION scale = 1.0f / (dc * (FTR_PRECISION)cic_gain(cic));
+    for(int m=0; m<nc; m++){
+        FTR_PRECISION c = M[m][nc] / M[m][m] * scale;
+        h[taps/2 + m] = c;
+        h[taps/2 - m] = c;
+    }
+    init_fir(fir, h, taps);
+}
@@ -0,0 +1,42 @@
+#include "crossfade.h"
+
+void init_crossfade(Crossfade* x, int len) {
+    if (len < 1) len = 1;
+    if (len > UINT16_MAX) len = UINT16_MAX;
+    x->len = (uint16_t)len;
+    x->pos = x->len;
+    x->step = 1.0f / (FTR_PRECISION)len;
+    x->offset = 0;
+}
+
+void crossfade_start(Crossfade* x, FTR_PRECISION offset) {
+    x->pos = 0;
+    x->offset = offset;
+}
+
+int crossfade_active(const Crossfade* x) { return x->pos < x->len; }
+
+FTR_PRECISION crossfade(Crossfade* x, FTR_PRECISION from, FTR_PRECISION to) {
+    if (x->pos >= x->len) return to;
+    FTR_PRECISION g = (FTR_PRECISION)(++x->pos) * x->step;
+    return from + g * (to - from);
+}
+
+void crossfade_block(Crossfade* x, const FTR_PRECISION* from, FTR_PRECISION* to, int n) {
+    FTR_PRECISION g = (FTR_PRECISION)x->pos * x->step, step = x->step;
+    for (int k = 0; k < n && x->pos < x->len; k++) {
+        x->pos++;
+        g += step;
+        to[k] = from[k] + g * (to[k] - from[k]);
+    }
+}
+
+void crossfade_offset_block(Crossfade* x, FTR_PRECISION* buf, int n) {
+    FTR_PRECISION step = x->step, d = x->offset * (1.0f - (FTR_PRECISION)x->pos * step);
+    FTR_PRECISION dd = x->offset * step;
+    for (int k = 0; k < n && x->pos < x->len; k++) {
+        x->pos++;
+        d -= dd;
+        buf[k] += d;
+    }
+}
@@ -0,0 +1,121 @@
+#include "fft.h"
+
+#define QUARTER_TURN 0x40000000u
+
+static inline q15_t cos_q15(uint32_t phase) { return ftr_sin_q15(phase + QUARTER_TURN); }
+
+static inline q15_t round_shift(int32_t v, int s) { return q15_sat((v + (1 << (s - 1))) >> s); }
+
+// --- Windows ---
+
+void fft_window_q15(q15_t* x, int n, int window) {
+    if(window == FFT_WINDOW_NONE || n < 2) return;
+    uint32_t step = (uint32_t)(4294967296.0f / (float)n);
+    for(int i=0; i<n; i++){
+        uint32_t ph = step * (uint32_t)i;
+        int32_t w;  // Q15
+        if(window == FFT_WINDOW_BLACKMAN)
+            w = 13763 - (cos_q15(ph) >> 1) + (((int32_t)cos_q15(2 * ph) * 2621) >> 15);  // 0.42 - 0.5c + 0.08c2
+        else
+            w = 16384 - (cos_q15(ph) >> 1);                                            // 0.5 - 0.5c
+        x[i] = round_shift((int32_t)x[i] * w, 15);
+    }
+}
+
+// --- Complex FFT ---
+
+static void bit_reverse(q15_t* x, int n) {
+    for(int i=1, j=0; i<n; i++){
+        int bit = n >> 1;
+        for(; j & bit; bit >>= 1) j ^= bit;
+        j |= bit;
+        if(i < j){
+            q15_t t = x[2*i]; x[2*i] = x[2*j]; x[2*j] = t;
+            t = x[2*i+1]; x[2*i+1] = x[2*j+1]; x[2*j+1] = t;
+        }
+    }
+}
+
+void fft_complex_q15(q15_t* x, int log2n) {
+    int n = 1 << log2n;
+    bit_reverse(x, n);
+    for(int size=2; size<=n; size<<=1){
+        int half = size >> 1;
+        uint32_t step = (uint32_t)(4294967296.0f / (float)size);
+        for(int k=0; k<half; k++){
+            int32_t wr = cos_q15(step * (uint32_t)k);
+            int32_t wi = -ftr_sin_q15(step * (uint32_t)k);  // e^(-j 2 pi k / size)
+            for(int j=k; j<n; j+=size){
+                q15_t* a = x + 2*j;
+                q15_t* b = x + 2*(j + half);
+                int32_t tr = (wr * b[0] - wi * b[1]) >> 15;
+                int32_t ti = (wr * b[1] + wi * b[0]) >> 15;
+                int32_t ar = a[0], ai = a[1];
+                a[0] = round_shift(ar + tr, 1);
+                a[1] = round_shift(ai + ti, 1);
+                b[0] = round_shift(ar - tr, 1);
+                b[1] = round_shift(ai - ti, 1);
+            }
+        }
+    }
+}
+
+// --- Real FFT ---
+// z[i] = x[2i] + j x[2i+1] transforms to Z = E + j O where E, O are the spectra of
+// the even and odd samples. With A = Z[k], B = Z[m-k] (m = n/2):
+//   E = (A + B*) / 2, O = -j (A - B*) / 2, X[k] = E + W^k O, X[m-k] = (E - W^k O)*
+// and W = e^(-j 2 pi / n). Z carries 1/m; the final halving makes it 1/n.
+
+void fft_real_q15(q15_t* x, int log2n) {
+    if(log2n < 1) return;
+    int n = 1 << log2n, m = n >> 1;
+    fft_complex_q15(x, log2n - 1);
+
+    int32_t r0 = x[0], i0 = x[1];
+    x[0] = round_shift(r0 + i0, 1);
+    x[1] = round_shift(r0 - i0, 1);
+
+    uint32_t step = (uint32_t)(4294967296.0f / (float)n);
+    for(int k=1; k<=m/2; k++){
+        q15_t* a = x + 2*k;
+        q15_t* b = x + 2*(m - k);
+        int32_t ar = a[0], ai = a[1], br = b[0], bi = b[1];
+        int32_t er = ar + br, ei = ai - bi;     // 2E
+        int32_t or_ = ai + bi, oi = br - ar;    // 2O = -j (A - B*)
+        int32_t wr = cos_q15(step * (uint32_t)k);
+        int32_t wi = -ftr_sin_q15(step * (uint32_t)k);
+        int32_t tr = (wr * or_ - wi * oi) >> 15;  // 2 W O
+        int32_t ti = (wr * oi + wi * or_) >> 15;
+        a[0] = round_shift(er + tr, 2);
+        a[1] = round_shift(ei + ti, 2);
+        b[0] = round_shift(er - tr, 2);
+        b[1] = round_shift(ti - ei, 2);
+    }
+}
+
+// --- Magnitudes ---
+
+void fft_mag2_q15(const q15_t* X, int n, uint32_t* mag2) {
+    mag2[0] = (uint32_t)((int32_t)X[0] * X[0]);
+    for(int k=1; k<n/2; k++){
+        int32_t re = X[2*k], im = X[2*k+1];
+        mag2[k] = (uint32_t)(re * re) + (uint32_t)(im * im);
+    }
+}
+
+// Octave from the leading bit, eighths from the next three mantissa bits.
+static uint8_t log2_8(uint32_t v) {
+    if(v == 0) return 0;
+    int msb = 31;
+    while(!(v & 0x80000000u)) { v <<= 1; msb--; }
+    return (uint8_t)(msb * 8 + ((v >> 28) & 7));
+}
+
+// out[k] lies inside X[k/2], which is read before it is overwritten.
+void fft_log_mag_q15(const q15_t* X, int n, uint8_t* out) {
+    out[0] = log2_8((uint32_t)((int32_t)X[0] * X[0]));
+    for(int k=1; k<n/2; k++){
+        int32_t re = X[2*k], im = X[2*k+1];
+        out[k] = log2_8((uint32_t)(re * re) + (uint32_t)(im * im));
+    }
+}
@@ -1,157 +1,491 @@
 #include "filter.h"
+#include "filter_q.h"
+#include "filter_cpx.h"
 
-// --- BETTER TINY MATH (Bhaskara I approximation) ---
-// Error < 0.0016 across 0 to PI
-static float my_abs(float x) { return (x < 0) ? -x : x; }
+// --- TABLE TRIG ---
+// Quarter-wave sine, 257 points over [0, PI/2] scaled by 65535 (514 bytes of
+// flash). Linear interpolation keeps the error below 3e-5 with a fixed cost:
+// one table pair, one multiply and a quadrant fold, no loops, no divides.
+#define SINE_TABLE_BITS 8
+#define SINE_TABLE_SIZE (1 << SINE_TABLE_BITS)
 
-static float my_sin(float x) {
-    // Normalize to -PI to PI
-    while (x > M_PI) x -= 2*M_PI;
-    while (x < -M_PI) x += 2*M_PI;
+static const unsigned short sine_table[SINE_TABLE_SIZE + 1] = {
+        0,   402,   804,  1206,  1608,  2010,  2412,  2814,  3216,  3617,  4019,  4420,
+     4821,  5222,  5623,  6023,  6424,  6824,  7223,  7623,  8022,  8421,  8820,  9218,
+     9616, 10014, 10411, 10808, 11204, 11600, 11996, 12391, 12785, 13179, 13573, 13966,
+    14359, 14751, 15142, 15533, 15924, 16313, 16703, 17091, 17479, 17866, 18253, 18639,
+    19024, 19408, 19792, 20175, 20557, 20939, 21319, 21699, 22078, 22456, 22834, 23210,
+    23586, 23960, 24334, 24707, 25079, 25450, 25820, 26189, 26557, 26925, 27291, 27656,
+    28020, 28383, 28745, 29106, 29465, 29824, 30181, 30538, 30893, 31247, 31600, 31952,
+    32302, 32651, 32999, 33346, 33692, 34036, 34379, 34721, 35061, 35400, 35738, 36074,
+    36409, 36743, 37075, 37406, 37736, 38064, 38390, 38715, 39039, 39361, 39682, 40001,
+    40319, 40635, 40950, 41263, 41575, 41885, 42194, 42500, 42806, 43109, 43411, 43712,
+    44011, 44308, 44603, 44897, 45189, 45479, 45768, 46055, 46340, 46624, 46905, 47185,
+    47464, 47740, 48014, 48287, 48558, 48827, 49095, 49360, 49624, 49885, 50145, 50403,
+    50659, 50913, 51166, 51416, 51664, 51911, 52155, 52398, 52638, 52877, 53113, 53348,
+    53580, 53811, 54039, 54266, 54490, 54713, 54933, 55151, 55367, 55582, 55794, 56003,
+    56211, 56417, 56620, 56822, 57021, 57218, 57413, 57606, 57797, 57985, 58171, 58356,
+    58537, 58717, 58895, 59070, 59243, 59414, 59582, 59749, 59913, 60075, 60234, 60391,
+    60546, 60699, 60850, 60998, 61144, 61287, 61429, 61567, 61704, 61838, 61970, 62100,
+    62227, 62352, 62475, 62595, 62713, 62829, 62942, 63053, 63161, 63267, 63371, 63472,
+    63571, 63668, 63762, 63853, 63943, 64030, 64114, 64196, 64276, 64353, 64428, 64500,
+    64570, 64638, 64703, 64765, 64826, 64883, 64939, 64992, 65042, 65090, 65136, 65179,
+    65219, 65258, 65293, 65327, 65357, 65386, 65412, 65435, 65456, 65475, 65491, 65504,
+    65515, 65524, 65530, 65534, 65535
+};
 
-    // If negative, flip sign
-    float sign = 1.0f;
-    if (x < 0) { x = -x; sign = -1.0f; }
+// phase: full circle = 2^32. Returns sin * 65535.
+static int sine_phase(unsigned int phase) {
+    unsigned int q = phase >> 30;
+    unsigned int j = (phase >> (30 - SINE_TABLE_BITS)) & (SINE_TABLE_SIZE - 1);
+    int frac = (int)((phase >> (14 - SINE_TABLE_BITS)) & 0xFFFF);
+    int a, b;
+    if (q & 1) { a = sine_table[SINE_TABLE_SIZE - j]; b = sine_table[SINE_TABLE_SIZE - 1 - j]; }
+    else       { a = sine_table[j];                   b = sine_table[j + 1]; }
+    int v = a + (((b - a) * frac) >> 16);
+    return (q & 2) ? -v : v;
+}
+
+static unsigned int phase_of(float x) {
+    float turns = x * (1.0f / (2.0f * M_PI));
+    turns -= (float)(int)turns;
+    if (turns < 0) turns += 1.0f;
+    return (unsigned int)(turns * 4294967040.0f); // largest float below 2^32
+}
+
+FTR_PRECISION ftr_sin(FTR_PRECISION x) { return sine_phase(phase_of(x)) * (1.0f / 65535.0f); }
+FTR_PRECISION ftr_cos(FTR_PRECISION x) { return sine_phase(phase_of(x) + 0x40000000u) * (1.0f / 65535.0f); }
+
+FTR_PRECISION ftr_tan(FTR_PRECISION x) {
+    unsigned int p = phase_of(x);
+    int c = sine_phase(p + 0x40000000u);
+    if (c == 0) return 10000.0f; // Avoid div by zero (saturate)
+    return (FTR_PRECISION)sine_phase(p) / (FTR_PRECISION)c;
+}
+
+q15_t ftr_sin_q15(uint32_t phase) { return (q15_t)(sine_phase(phase) / 2); }
 
-    // Bhaskara I formula: 16*x*(pi-x) / (5*pi^2 - 4*x*(pi-x))
-    float numerator = 16.0f * x * (M_PI - x);
-    float denominator = (5.0f * M_PI * M_PI) - (4.0f * x * (M_PI - x));
+// Newton square root; the bit-level seed is within a few percent, so three
+// iterations reach full float precision.
+FTR_PRECISION ftr_sqrt(FTR_PRECISION x) {
+    if (x <= 0.0f) return 0.0f;
+    union { float f; unsigned int i; } u = { x };
+    u.i = (u.i >> 1) + 0x1fbd1df5u;
+    float y = u.f;
+    for (int k = 0; k < 3; ++k) y = 0.5f * (y + x / y);
+    return y;
+}
 
-    return sign * (numerator / denominator);
+// exp(x) = 2^k * exp(r), |r| <= ln2/2: the Taylor series to r^7 is below 1 ulp.
+FTR_PRECISION ftr_exp(FTR_PRECISION x) {
+    if (x > 88.0f) x = 88.0f;
+    if (x < -87.0f) return 0.0f;
+    int k = (int)(x * 1.4426950f + (x < 0 ? -0.5f : 0.5f));
+    float r = (x - (float)k * 0.693145752f) - (float)k * 1.42860677e-6f; // ln2 split in two
+    float e = 1.0f + r*(1.0f + r*(1.0f/2 + r*(1.0f/6 + r*(1.0f/24 + r*(1.0f/120 + r*(1.0f/720 + r*(1.0f/5040)))))));
+    union { float f; unsigned int i; } u;
+    u.i = (unsigned int)(k + 127) << 23;
+    return e * u.f;
 }
 
-static float my_cos(float x) {
-    return my_sin(x + 1.5707963f); // cos(x) = sin(x + PI/2)
+// log(x) = e*ln2 + 2*atanh(t), t = (m-1)/(m+1) with m in [sqrt(0.5), sqrt(2)).
+FTR_PRECISION ftr_log(FTR_PRECISION x) {
+    if (x <= 0.0f) return -88.0f;
+    union { float f; unsigned int i; } u = { x };
+    int e = (int)((u.i >> 23) & 0xFF) - 127;
+    u.i = (u.i & 0x007FFFFFu) | 0x3F800000u;
+    if (u.f > 1.41421356f) { u.f *= 0.5f; e++; }
+    float t = (u.f - 1.0f) / (u.f + 1.0f), t2 = t * t;
+    return (float)e * 0.69314718f + 2.0f * t * (1.0f + t2*(1.0f/3 + t2*(1.0f/5 + t2*(1.0f/7 + t2*(1.0f/9)))));
 }
 
-static float my_tan(float x) {
-    float c = my_cos(x);
-    if (my_abs(c) < 1e-5f) return 10000.0f; // Avoid div by zero (saturate)
-    return my_sin(x) / c;
+// Octant fold to |z| <= 1, then atan(z) = pi/6 + atan((sqrt3*z - 1)/(sqrt3 + z)) above
+// tan(pi/12), so the odd series runs on |t| <= 0.27.
+FTR_PRECISION ftr_atan2(FTR_PRECISION y, FTR_PRECISION x) {
+    float ax = x < 0 ? -x : x, ay = y < 0 ? -y : y;
+    if (ax == 0.0f && ay == 0.0f) return 0.0f;
+    int swap = ay > ax;
+    float z = swap ? ax / ay : ay / ax, a = 0.0f;
+    if (z > 0.26794919f) { z = (1.73205081f * z - 1.0f) / (1.73205081f + z); a = M_PI / 6.0f; }
+    float z2 = z * z;
+    a += z * (1.0f - z2*(1.0f/3 - z2*(1.0f/5 - z2*(1.0f/7 - z2*(1.0f/9 - z2*(1.0f/11))))));
+    if (swap) a = 0.5f * M_PI - a;
+    if (x < 0) a = M_PI - a;
+    return y < 0 ? -a : a;
 }
 // ----------------------------------------------------
 
 void init_bw_low_pass(BWLowPass* filter, int order, FTR_PRECISION s, FTR_PRECISION f) {
     filter->n = order/2;
     if(filter->n > MAX_SECTIONS) filter->n = MAX_SECTIONS;
-    for(int k=0; k<MAX_SECTIONS; k++) { filter->w0[k]=0; filter->w1[k]=0; filter->w2[k]=0; }
+    for(int k=0; k<MAX_SECTIONS; k++) { filter->w1[k]=0; filter->w2[k]=0; }
+    filter->G = 1.0f;
 
-    FTR_PRECISION a = my_tan(M_PI * f / s);
+    FTR_PRECISION a = ftr_tan(M_PI * f / s);
     FTR_PRECISION a2 = a * a;
 
     for(int i=0; i < filter->n; ++i){
-        FTR_PRECISION r = my_sin(M_PI * (2.0f * i + 1.0f) / (4.0f * filter->n));
+        FTR_PRECISION r = ftr_sin(M_PI * (2.0f * i + 1.0f) / (4.0f * filter->n));
         FTR_PRECISION s_val = (a2 + 2.0f * a * r + 1.0f);
         filter->A[i] = a2 / s_val;
         filter->d1[i] = 2.0f * (1.0f - a2) / s_val;
         filter->d2[i] = -(a2 - 2.0f * a * r + 1.0f) / s_val;
+        filter->G *= filter->A[i];
     }
 }
 
 void init_bw_high_pass(BWHighPass* filter, int order, FTR_PRECISION s, FTR_PRECISION f){
     filter->n = order/2;
     if(filter->n > MAX_SECTIONS) filter->n = MAX_SECTIONS;
-    for(int k=0; k<MAX_SECTIONS; k++) { filter->w0[k]=0; filter->w1[k]=0; filter->w2[k]=0; }
+    for(int k=0; k<MAX_SECTIONS; k++) { filter->w1[k]=0; filter->w2[k]=0; }
+    filter->G = 1.0f;
 
-    FTR_PRECISION a = my_tan(M_PI * f / s);
+    FTR_PRECISION a = ftr_tan(M_PI * f / s);
     FTR_PRECISION a2 = a * a;
 
     for(int i=0; i < filter->n; ++i){
-        FTR_PRECISION r = my_sin(M_PI * (2.0f * i + 1.0f) / (4.0f * filter->n));
+        FTR_PRECISION r = ftr_sin(M_PI * (2.0f * i + 1.0f) / (4.0f * filter->n));
         FTR_PRECISION s_val = (a2 + 2.0f * a * r + 1.0f);
         filter->A[i] = 1.0f / s_val;
         filter->d1[i] = 2.0f * (1.0f - a2) / s_val;
         filter->d2[i] = -(a2 - 2.0f * a * r + 1.0f) / s_val;
+        filter->G *= filter->A[i];
     }
 }
 
-void init_bw_band_pass(BWBandPass* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu){
-    filter->n = order/4;
-    if(filter->n > MAX_SECTIONS) filter->n = MAX_SECTIONS;
-    for(int k=0; k<MAX_SECTIONS; k++) {
-        filter->w0[k]=0; filter->w1[k]=0; filter->w2[k]=0;
-        filter->w3[k]=0; filter->w4[k]=0;
+// DF-II steady state for a constant input x: w = x/(1-d1-d2) in every delay, and the
+// unscaled section output (1, +-2, 1)*w is 4w (LPF) or 0 (HPF) for the next section.
+static void prime_biquad(BWLowPass* filter, FTR_PRECISION x, int high) {
+    for(int i=0; i<filter->n; ++i){
+        FTR_PRECISION w = x / (1.0f - filter->d1[i] - filter->d2[i]);
+        filter->w1[i] = w;
+        filter->w2[i] = w;
+        x = high ? 0.0f : 4.0f * w;
     }
+}
 
-    FTR_PRECISION a = my_cos(M_PI*(fu+fl)/s) / my_cos(M_PI*(fu-fl)/s);
-    FTR_PRECISION a2 = a*a;
-    FTR_PRECISION b = my_tan(M_PI*(fu-fl)/s);
-    FTR_PRECISION b2 = b*b;
+void bw_low_pass_prime(BWLowPass* filter, FTR_PRECISION x) { prime_biquad(filter, x, 0); }
+void bw_high_pass_prime(BWHighPass* filter, FTR_PRECISION x) { prime_biquad(filter, x, 1); }
+void bw_band_pass_prime(BWBandPass* filter, FTR_PRECISION x) { sos_prime(filter, x); }
+void bw_band_stop_prime(BWBandStop* filter, FTR_PRECISION x) { sos_prime(filter, x); }
+
+// --- Second-order-section designers ---
 
+void sos_reset(SOSCascade* filter) {
+    for(int k=0; k<SOS_MAX_SECTIONS; k++) { filter->w1[k]=0; filter->w2[k]=0; }
+}
+
+// DF-II steady state for a constant input u: w0 = w1 = w2 = u/(1+a1+a2), and the
+// section then passes (b0+b1+b2)*w on to the next one.
+void sos_prime(SOSCascade* filter, FTR_PRECISION x) {
     for(int i=0; i<filter->n; ++i){
-        FTR_PRECISION r = my_sin(M_PI * (2.0f * i + 1.0f) / (4.0f * filter->n));
-        FTR_PRECISION s_val = (b2 + 2.0f * b * r + 1.0f);
-        filter->A[i] = b2/s_val;
-        filter->d1[i] = 4.0f * a * (1.0f + b * r) / s_val;
-        filter->d2[i] = 2.0f * (b2 - 2.0f * a2 - 1.0f)/ s_val;
-        filter->d3[i] = 4.0f * a * (1.0f - b * r ) / s_val;
-        filter->d4[i] = -(b2 - 2.0f * b * r + 1.0f) / s_val;
+        FTR_PRECISION w = x / (1.0f + filter->a1[i] + filter->a2[i]);
+        filter->w1[i] = w;
+        filter->w2[i] = w;
+        x = (filter->b0[i] + filter->b1[i] + filter->b2[i]) * w;
     }
 }
 
-void init_bw_band_stop(BWBandStop* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu){
-    filter->n = order/4;
-    if(filter->n > MAX_SECTIONS) filter->n = MAX_SECTIONS;
-    for(int k=0; k<MAX_SECTIONS; k++) {
-        filter->w0[k]=0; filter->w1[k]=0; filter->w2[k]=0;
-        filter->w3[k]=0; filter->w4[k]=0;
+// Unscaled state for sos_cascade_lp/hp: the section passes 4w (LPF) or 0 (HPF).
+static void sos_prime_folded(SOSCascade* filter, FTR_PRECISION x, int high) {
+    for(int i=0; i<filter->n; ++i){
+        FTR_PRECISION w = x / (1.0f + filter->a1[i] + filter->a2[i]);
+        filter->w1[i] = w;
+        filter->w2[i] = w;
+        x = high ? 0.0f : 4.0f * w;
     }
+}
 
-    FTR_PRECISION a = my_cos(M_PI*(fu+fl)/s) / my_cos(M_PI*(fu-fl)/s);
-    FTR_PRECISION a2 = a*a;
-    FTR_PRECISION b = my_tan(M_PI*(fu-fl)/s);
-    FTR_PRECISION b2 = b*b;
+void sos_prime_lp(SOSCascade* filter, FTR_PRECISION x) { sos_prime_folded(filter, x, 0); }
+void sos_prime_hp(SOSCascade* filter, FTR_PRECISION x) { sos_prime_folded(filter, x, 1); }
 
+// TDF-II: every section settles to y = H(1)*x, then y = b0*x + s1 and s2 = b2*x - a2*y.
+void sos_prime_tdf2(SOSCascade* filter, FTR_PRECISION x) {
     for(int i=0; i<filter->n; ++i){
-        FTR_PRECISION r = my_sin(M_PI * (2.0f * i + 1.0f) / (4.0f * filter->n));
+        FTR_PRECISION y = (filter->b0[i] + filter->b1[i] + filter->b2[i]) * x
+                        / (1.0f + filter->a1[i] + filter->a2[i]);
+        filter->w1[i] = y - filter->b0[i] * x;
+        filter->w2[i] = filter->b2[i] * x - filter->a2[i] * y;
+        x = y;
+    }
+}
+
+void init_bw_low_pass_sos(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f) {
+    filter->n = order/2;
+    if(filter->n > SOS_MAX_SECTIONS) filter->n = SOS_MAX_SECTIONS;
+    sos_reset(filter);
+    filter->G = 1.0f;
+
+    FTR_PRECISION a = ftr_tan(M_PI * f / s);
+    FTR_PRECISION a2 = a * a;
+
+    for(int i=0; i < filter->n; ++i){
+        FTR_PRECISION r = ftr_sin(M_PI * (2.0f * i + 1.0f) / (4.0f * filter->n));
+        FTR_PRECISION s_val = (a2 + 2.0f * a * r + 1.0f);
+        FTR_PRECISION A = a2 / s_val;
+        filter->G *= A;
+        filter->b0[i] = A;
+        filter->b1[i] = 2.0f * A;
+        filter->b2[i] = A;
+        filter->a1[i] = -2.0f * (1.0f - a2) / s_val;
+        filter->a2[i] = (a2 - 2.0f * a * r + 1.0f) / s_val;
+    }
+}
+
+void init_bw_high_pass_sos(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f) {
+    filter->n = order/2;
+    if(filter->n > SOS_MAX_SECTIONS) filter->n = SOS_MAX_SECTIONS;
+    sos_reset(filter);
+    filter->G = 1.0f;
+
+    FTR_PRECISION a = ftr_tan(M_PI * f / s);
+    FTR_PRECISION a2 = a * a;
+
+    for(int i=0; i < filter->n; ++i){
+        FTR_PRECISION r = ftr_sin(M_PI * (2.0f * i + 1.0f) / (4.0f * filter->n));
+        FTR_PRECISION s_val = (a2 + 2.0f * a * r + 1.0f);
+        FTR_PRECISION A = 1.0f / s_val;
+        filter->G *= A;
+        filter->b0[i] = A;
+        filter->b1[i] = -2.0f * A;
+        filter->b2[i] = A;
+        filter->a1[i] = -2.0f * (1.0f - a2) / s_val;
+        filter->a2[i] = (a2 - 2.0f * a * r + 1.0f) / s_val;
+    }
+}
+
+// Splits every 4th-order band section into two biquads. The band transform maps
+// each lowpass prototype pole q (bandwidth b) onto the roots of
+// z^2 - a(1+q) z + q = 0; each root and its conjugate form one biquad. The
+// section gain A is shared as sqrt(A) so neither biquad runs hot or starved.
+static void bw_band_sections(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, int stop) {
+    int n4 = order/4;
+    if(2*n4 > SOS_MAX_SECTIONS) n4 = SOS_MAX_SECTIONS/2;
+    filter->n = 2*n4;
+    sos_reset(filter);
+
+    FTR_PRECISION a = ftr_cos(M_PI*(fu+fl)/s) / ftr_cos(M_PI*(fu-fl)/s);
+    FTR_PRECISION b = ftr_tan(M_PI*(fu-fl)/s);
+    FTR_PRECISION b2 = b*b;
+
+    for(int i=0; i<n4; ++i){
+        FTR_PRECISION r = ftr_sin(M_PI * (2.0f * i + 1.0f) / (4.0f * n4));
         FTR_PRECISION s_val = (b2 + 2.0f * b * r + 1.0f);
-        filter->A[i] = 1.0f / s_val;
-        filter->d1[i] = 4.0f * a * (1.0f + b * r ) / s_val;
-        filter->d2[i] = 2.0f * (b2 - 2.0f * a2 - 1.0f) / s_val;
-        filter->d3[i] = 4.0f * a * (1.0f - b * r) / s_val;
-        filter->d4[i] = -(b2 - 2.0f * b * r + 1.0f) / s_val;
+        FTR_PRECISION g = ftr_sqrt((stop ? 1.0f : b2) / s_val);
+
+        // Lowpass prototype pole: z^2 - d1 z - d2 = 0
+        FTR_PRECISION d1 = 2.0f * (1.0f - b2) / s_val;
+        FTR_PRECISION d2 = -(b2 - 2.0f * b * r + 1.0f) / s_val;
+        cpx q = cx(0.5f * d1, 0.5f * ftr_sqrt(-(d1*d1 + 4.0f*d2)));
+
+        cpx c = c_scale(c_add(cx(1, 0), q), a);
+        cpx disc = c_sqrt(c_sub(c_mul(c, c), c_scale(q, 4.0f)));
+
+        for(int k=0; k<2; ++k){
+            int j = 2*i + k;
+            cpx p = c_scale(k ? c_sub(c, disc) : c_add(c, disc), 0.5f);
+            filter->a1[j] = -2.0f * p.re;
+            filter->a2[j] = c_abs2(p);
+            filter->b0[j] = g;
+            filter->b1[j] = stop ? -2.0f * a * g : 0.0f;
+            filter->b2[j] = stop ? g : -g;
+        }
     }
-    filter->r = 4.0f * a;
-    filter->s = 4.0f * a2 + 2.0f;
+}
+
+void init_bw_band_pass_sos(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu) {
+    bw_band_sections(filter, order, s, fl, fu, 0);
+}
+
+void init_bw_band_stop_sos(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu) {
+    bw_band_sections(filter, order, s, fl, fu, 1);
+}
+
+void init_bw_band_pass(BWBandPass* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu){
+    bw_band_sections(filter, order, s, fl, fu, 0);
+}
+
+void init_bw_band_stop(BWBandStop* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu){
+    bw_band_sections(filter, order, s, fl, fu, 1);
 }
 
 FTR_PRECISION bw_low_pass(BWLowPass* filter, FTR_PRECISION x){
     for(int i=0; i<filter->n; ++i){
-        filter->w0[i] = filter->d1[i]*filter->w1[i] + filter->d2[i]*filter->w2[i] + x;
-        x = filter->A[i] * (filter->w0[i] + 2.0f * filter->w1[i] + filter->w2[i]);
+        FTR_PRECISION w0 = filter->d1[i]*filter->w1[i] + filter->d2[i]*filter->w2[i] + x;
+        x = (w0 + filter->w2[i]) + (filter->w1[i] + filter->w1[i]);
         filter->w2[i] = filter->w1[i];
-        filter->w1[i] = filter->w0[i];
+        filter->w1[i] = w0;
     }
-    return x;
+    return filter->G * x;
 }
 FTR_PRECISION bw_high_pass(BWHighPass* filter, FTR_PRECISION x){
     for(int i=0; i<filter->n; ++i){
-        filter->w0[i] = filter->d1[i]*filter->w1[i] + filter->d2[i]*filter->w2[i] + x;
-        x = filter->A[i] * (filter->w0[i] - 2.0f * filter->w1[i] + filter->w2[i]);
+        FTR_PRECISION w0 = filter->d1[i]*filter->w1[i] + filter->d2[i]*filter->w2[i] + x;
+        x = (w0 + filter->w2[i]) - (filter->w1[i] + filter->w1[i]);
         filter->w2[i] = filter->w1[i];
-        filter->w1[i] = filter->w0[i];
+        filter->w1[i] = w0;
     }
-    return x;
+    return filter->G * x;
 }
 FTR_PRECISION bw_band_pass(BWBandPass* filter, FTR_PRECISION x){
+    return sos_cascade(filter, x);
+}
+FTR_PRECISION bw_band_stop(BWBandStop* filter, FTR_PRECISION x){
+    return sos_cascade(filter, x);
+}
+
+FTR_PRECISION sos_cascade(SOSCascade* filter, FTR_PRECISION x){
     for(int i=0; i<filter->n; ++i){
-        filter->w0[i] = filter->d1[i]*filter->w1[i] + filter->d2[i]*filter->w2[i]+ filter->d3[i]*filter->w3[i]+ filter->d4[i]*filter->w4[i] + x;
-        x = filter->A[i] * (filter->w0[i] - 2.0f * filter->w2[i] + filter->w4[i]);
-        filter->w4[i] = filter->w3[i];
-        filter->w3[i] = filter->w2[i];
+        FTR_PRECISION w0 = x - filter->a1[i]*filter->w1[i] - filter->a2[i]*filter->w2[i];
+        x = filter->b0[i]*w0 + filter->b1[i]*filter->w1[i] + filter->b2[i]*filter->w2[i];
         filter->w2[i] = filter->w1[i];
-        filter->w1[i] = filter->w0[i];
+        filter->w1[i] = w0;
     }
     return x;
 }
-FTR_PRECISION bw_band_stop(BWBandStop* filter, FTR_PRECISION x){
+
+FTR_PRECISION sos_cascade_tdf2(SOSCascade* filter, FTR_PRECISION x){
     for(int i=0; i<filter->n; ++i){
-        filter->w0[i] = filter->d1[i]*filter->w1[i] + filter->d2[i]*filter->w2[i]+ filter->d3[i]*filter->w3[i]+ filter->d4[i]*filter->w4[i] + x;
-        x = filter->A[i]*(filter->w0[i] - filter->r*filter->w1[i] + filter->s*filter->w2[i]- filter->r*filter->w3[i] + filter->w4[i]);
-        filter->w4[i] = filter->w3[i];
-        filter->w3[i] = filter->w2[i];
-        filter->w2[i] = filter->w1[i];
-        filter->w1[i] = filter->w0[i];
+        FTR_PRECISION y = filter->b0[i]*x + filter->w1[i];
+        filter->w1[i] = filter->b1[i]*x + filter->w2[i] - filter->a1[i]*y;
+        filter->w2[i] = filter->b2[i]*x - filter->a2[i]*y;
+        x = y;
     }
     return x;
 }
+
+FTR_PRECISION sos_cascade_lp(SOSCascade* filter, FTR_PRECISION x){
+    for(int i=0; i<filter->n; ++i){
+        FTR_PRECISION w0 = x - filter->a1[i]*filter->w1[i] - filter->a2[i]*filter->w2[i];
+        x = (w0 + filter->w2[i]) + (filter->w1[i] + filter->w1[i]);
+        filter->w2[i] = filter->w1[i];
+        filter->w1[i] = w0;
+    }
+    return filter->G * x;
+}
+
+FTR_PRECISION sos_cascade_hp(SOSCascade* filter, FTR_PRECISION x){
+    for(int i=0; i<filter->n; ++i){
+        FTR_PRECISION w0 = x - filter->a1[i]*filter->w1[i] - filter->a2[i]*filter->w2[i];
+        x = (w0 + filter->w2[i]) - (filter->w1[i] + filter->w1[i]);
+        filter->w2[i] = filter->w1[i];
+        filter->w1[i] = w0;
+    }
+    return filter->G * x;
+}
+
+// --- Block processing ---
+// Section-major: the first section reads 'in', later sections rework 'out' in place.
+
+void bw_low_pass_block(BWLowPass* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n){
+    const FTR_PRECISION* src = in;
+    for(int i=0; i<filter->n; ++i){
+        FTR_PRECISION d1 = filter->d1[i], d2 = filter->d2[i];
+        FTR_PRECISION w1 = filter->w1[i], w2 = filter->w2[i];
+        for(int k=0; k<n; ++k){
+            FTR_PRECISION w0 = d1*w1 + d2*w2 + src[k];
+            out[k] = (w0 + w2) + (w1 + w1);
+            w2 = w1;
+            w1 = w0;
+        }
+        filter->w1[i] = w1; filter->w2[i] = w2;
+        src = out;
+    }
+    FTR_PRECISION G = filter->G;
+    for(int k=0; k<n; ++k) out[k] = G * src[k];
+}
+
+void bw_high_pass_block(BWHighPass* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n){
+    const FTR_PRECISION* src = in;
+    for(int i=0; i<filter->n; ++i){
+        FTR_PRECISION d1 = filter->d1[i], d2 = filter->d2[i];
+        FTR_PRECISION w1 = filter->w1[i], w2 = filter->w2[i];
+        for(int k=0; k<n; ++k){
+            FTR_PRECISION w0 = d1*w1 + d2*w2 + src[k];
+            out[k] = (w0 + w2) - (w1 + w1);
+            w2 = w1;
+            w1 = w0;
+        }
+        filter->w1[i] = w1; filter->w2[i] = w2;
+        src = out;
+    }
+    FTR_PRECISION G = filter->G;
+    for(int k=0; k<n; ++k) out[k] = G * src[k];
+}
+
+void bw_band_pass_block(BWBandPass* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n){
+    sos_cascade_block(filter, in, out, n);
+}
+
+void bw_band_stop_block(BWBandStop* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n){
+    sos_cascade_block(filter, in, out, n);
+}
+
+void sos_cascade_block(SOSCascade* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n){
+    const FTR_PRECISION* src = in;
+    for(int i=0; i<filter->n; ++i){
+        FTR_PRECISION b0 = filter->b0[i], b1 = filter->b1[i], b2 = filter->b2[i];
+        FTR_PRECISION a1 = filter->a1[i], a2 = filter->a2[i];
+        FTR_PRECISION w1 = filter->w1[i], w2 = filter->w2[i];
+        for(int k=0; k<n; ++k){
+            FTR_PRECISION w0 = src[k] - a1*w1 - a2*w2;
+            out[k] = b0*w0 + b1*w1 + b2*w2;
+            w2 = w1;
+            w1 = w0;
+        }
+        filter->w1[i] = w1; filter->w2[i] = w2;
+        src = out;
+    }
+    if(src != out) for(int k=0; k<n; ++k) out[k] = in[k];
+}
+
+void sos_cascade_tdf2_block(SOSCascade* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n){
+    const FTR_PRECISION* src = in;
+    for(int i=0; i<filter->n; ++i){
+        FTR_PRECISION b0 = filter->b0[i], b1 = filter->b1[i], b2 = filter->b2[i];
+        FTR_PRECISION a1 = filter->a1[i], a2 = filter->a2[i];
+        FTR_PRECISION s1 = filter->w1[i], s2 = filter->w2[i];
+        for(int k=0; k<n; ++k){
+            FTR_PRECISION x = src[k];
+            FTR_PRECISION y = b0*x + s1;
+            s1 = b1*x + s2 - a1*y;
+            s2 = b2*x - a2*y;
+            out[k] = y;
+        }
+        filter->w1[i] = s1; filter->w2[i] = s2;
+        src = out;
+    }
+    if(src != out) for(int k=0; k<n; ++k) out[k] = in[k];
+}
+
+static void sos_cascade_folded_block(SOSCascade* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n, int high){
+    const FTR_PRECISION* src = in;
+    for(int i=0; i<filter->n; ++i){
+        FTR_PRECISION a1 = filter->a1[i], a2 = filter->a2[i];
+        FTR_PRECISION w1 = filter->w1[i], w2 = filter->w2[i];
+        if(high) for(int k=0; k<n; ++k){
+            FTR_PRECISION w0 = src[k] - a1*w1 - a2*w2;
+            out[k] = (w0 + w2) - (w1 + w1);
+            w2 = w1;
+            w1 = w0;
+        }
+        else for(int k=0; k<n; ++k){
+            FTR_PRECISION w0 = src[k] - a1*w1 - a2*w2;
+            out[k] = (w0 + w2) + (w1 + w1);
+            w2 = w1;
+            w1 = w0;
+        }
+        filter->w1[i] = w1; filter->w2[i] = w2;
+        src = out;
+    }
+    FTR_PRECISION G = filter->G;
+    for(int k=0; k<n; ++k) out[k] = G * src[k];
+}
+
+void sos_cascade_lp_block(SOSCascade* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n){
+    sos_cascade_folded_block(filter, in, out, n, 0);
+}
+
+void sos_cascade_hp_block(SOSCascade* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n){
+    sos_cascade_folded_block(filter, in, out, n, 1);
+}
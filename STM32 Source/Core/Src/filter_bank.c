@@ -0,0 +1,100 @@
+#include "filter_bank.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BANK_HOST_SIMD 1
+// Keep the scalar path unfused so it matches the SIMD kernels bit for bit.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#else
+#pragma GCC optimize ("fp-contract=off")
+#endif
+#endif
+
+void sos_bank_reset(SOSBank* bank) {
+    for(int i=0; i<SOS_MAX_SECTIONS; ++i)
+        for(int c=0; c<BANK_MAX_CHANNELS; ++c) { bank->w1[i][c] = 0; bank->w2[i][c] = 0; }
+}
+
+void sos_bank_init(SOSBank* bank, const SOSCascade* design, int channels) {
+    if(channels < 1) channels = 1;
+    if(channels > BANK_MAX_CHANNELS) channels = BANK_MAX_CHANNELS;
+    bank->n = design->n;
+    bank->channels = channels;
+    for(int i=0; i<design->n; ++i){
+        bank->b0[i] = design->b0[i];
+        bank->b1[i] = design->b1[i];
+        bank->b2[i] = design->b2[i];
+        bank->a1[i] = design->a1[i];
+        bank->a2[i] = design->a2[i];
+    }
+    sos_bank_reset(bank);
+}
+
+// DF-II steady state per channel, as sos_prime().
+void sos_bank_prime(SOSBank* bank, const FTR_PRECISION* x) {
+    for(int c=0; c<bank->channels; ++c){
+        FTR_PRECISION u = x[c];
+        for(int i=0; i<bank->n; ++i){
+            FTR_PRECISION w = u / (1.0f + bank->a1[i] + bank->a2[i]);
+            bank->w1[i][c] = w;
+            bank->w2[i][c] = w;
+            u = (bank->b0[i] + bank->b1[i] + bank->b2[i]) * w;
+        }
+    }
+}
+
+// Channels c0..channels-1 of one frame, section-major, Direct Form II like
+// sos_cascade(). The channel loop has no carried dependency.
+static void bank_frame(SOSBank* bank, const FTR_PRECISION* in, FTR_PRECISION* out, int c0) {
+    int m = bank->channels;
+    for(int c=c0; c<m; ++c) out[c] = in[c];
+    for(int i=0; i<bank->n; ++i){
+        FTR_PRECISION b0 = bank->b0[i], b1 = bank->b1[i], b2 = bank->b2[i];
+        FTR_PRECISION a1 = bank->a1[i], a2 = bank->a2[i];
+        FTR_PRECISION* w1 = bank->w1[i];
+        FTR_PRECISION* w2 = bank->w2[i];
+        for(int c=c0; c<m; ++c){
+            FTR_PRECISION w0 = out[c] - a1*w1[c] - a2*w2[c];
+            out[c] = b0*w0 + b1*w1[c] + b2*w2[c];
+            w2[c] = w1[c];
+            w1[c] = w0;
+        }
+    }
+}
+
+#if BANK_HOST_SIMD
+typedef int (*bank_simd_fn)(SOSBank*, const float*, float*, int, int);
+
+// 0: not probed yet, 1: scalar only, 2: AVX2, 3: AVX-512F.
+static int bank_simd_level(void) {
+    static int level;
+    if(!level){
+        __builtin_cpu_init();
+        level = __builtin_cpu_supports("avx512f") ? 3 : __builtin_cpu_supports("avx2") ? 2 : 1;
+    }
+    return level;
+}
+
+// Widest kernel first, narrower ones take the leftover full chunks, and the
+// scalar kernel finishes the last channels. Returns the first scalar channel.
+static int bank_simd(SOSBank* bank, const float* in, float* out, int frames) {
+    int level = bank_simd_level(), c = 0;
+    if(level >= 3) c = sos_bank_block_avx512(bank, in, out, frames, c);
+    if(level >= 2) c = sos_bank_block_avx2(bank, in, out, frames, c);
+    return c;
+}
+#endif
+
+void sos_bank_process_frame(SOSBank* bank, const FTR_PRECISION* in, FTR_PRECISION* out) {
+    sos_bank_process_block(bank, in, out, 1);
+}
+
+void sos_bank_process_block(SOSBank* bank, const FTR_PRECISION* in, FTR_PRECISION* out, int frames) {
+    int m = bank->channels, c0 = 0;
+#if BANK_HOST_SIMD
+    c0 = bank_simd(bank, in, out, frames);
+    if(c0 == m) return;
+#endif
+    for(int k=0; k<frames; ++k)
+        bank_frame(bank, in + k*m, out + k*m, c0);
+}
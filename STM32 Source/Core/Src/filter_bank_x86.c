@@ -0,0 +1,55 @@
+/* filter_bank_x86.c - HOST-ONLY AVX2/AVX-512 KERNELS FOR SOSBank
+ *
+ * Compiled to nothing on the MCU. Each vector lane is one channel and every lane
+ * runs the same mul/add/sub sequence as the scalar kernel, never fused, so the
+ * output is bit-identical whichever path sos_bank_process_block() picks.
+ */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#else
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+#include <immintrin.h>
+#include "filter_bank.h"
+
+// Channel-chunk outer, frame inner: the state of the chunk stays in registers for
+// the whole block and the coefficients are broadcast once per block.
+#define BANK_SIMD_KERNEL(name, isa, vec, width, set1, loadu, storeu, mul, add, sub) \
+__attribute__((target(isa))) \
+int name(SOSBank* bank, const float* in, float* out, int frames, int c0) { \
+    int m = bank->channels, n = bank->n; \
+    vec b0[SOS_MAX_SECTIONS], b1[SOS_MAX_SECTIONS], b2[SOS_MAX_SECTIONS]; \
+    vec a1[SOS_MAX_SECTIONS], a2[SOS_MAX_SECTIONS]; \
+    for(int i=0; i<n; ++i){ \
+        b0[i] = set1(bank->b0[i]); b1[i] = set1(bank->b1[i]); b2[i] = set1(bank->b2[i]); \
+        a1[i] = set1(bank->a1[i]); a2[i] = set1(bank->a2[i]); \
+    } \
+    int c = c0; \
+    for(; c + width <= m; c += width){ \
+        vec w1[SOS_MAX_SECTIONS], w2[SOS_MAX_SECTIONS]; \
+        for(int i=0; i<n; ++i){ w1[i] = loadu(&bank->w1[i][c]); w2[i] = loadu(&bank->w2[i][c]); } \
+        for(int k=0; k<frames; ++k){ \
+            vec x = loadu(in + (long)k*m + c); \
+            for(int i=0; i<n; ++i){ \
+                vec w0 = sub(sub(x, mul(a1[i], w1[i])), mul(a2[i], w2[i])); \
+                x = add(add(mul(b0[i], w0), mul(b1[i], w1[i])), mul(b2[i], w2[i])); \
+                w2[i] = w1[i]; \
+                w1[i] = w0; \
+            } \
+            storeu(out + (long)k*m + c, x); \
+        } \
+        for(int i=0; i<n; ++i){ storeu(&bank->w1[i][c], w1[i]); storeu(&bank->w2[i][c], w2[i]); } \
+    } \
+    return c; \
+}
+
+BANK_SIMD_KERNEL(sos_bank_block_avx2, "avx2", __m256, 8,
+    _mm256_set1_ps, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_mul_ps, _mm256_add_ps, _mm256_sub_ps)
+
+BANK_SIMD_KERNEL(sos_bank_block_avx512, "avx512f", __m512, 16,
+    _mm512_set1_ps, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_mul_ps, _mm512_add_ps, _mm512_sub_ps)
+
+#endif
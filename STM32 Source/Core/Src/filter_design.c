@@ -0,0 +1,466 @@
+#include "filter_design.h"
+#include "filter_cpx.h"
+#include "filter_q.h"
+
+// Analog prototypes are normalized to 1 rad/s, mapped to the band with the
+// prewarped edges, through the bilinear transform z = (1+s)/(1-s), then paired
+// into biquads. Init time only; uses the ftr_* helpers, no libm.
+
+#define MAX_ROOTS       (2 * SOS_MAX_SECTIONS)
+#define LANDEN_STEPS    8
+#define REAL_TOL        1e-6f
+#define PEAK_GRID       64
+#define FIT_MARGIN      0.999f      // rounding room below the Q2.x limits
+
+enum { LOW_PASS, HIGH_PASS, BAND_PASS, BAND_STOP };
+
+// --- Complex helpers beyond filter_cpx.h ---
+// cos(a + jb) = cos a cosh b - j sin a sinh b
+static cpx c_cos(cpx z) {
+    float e = ftr_exp(z.im), ch = 0.5f * (e + 1.0f / e), sh = 0.5f * (e - 1.0f / e);
+    return cx(ftr_cos(z.re) * ch, -ftr_sin(z.re) * sh);
+}
+
+static cpx c_sin(cpx z) {
+    float e = ftr_exp(z.im), ch = 0.5f * (e + 1.0f / e), sh = 0.5f * (e - 1.0f / e);
+    return cx(ftr_sin(z.re) * ch, ftr_cos(z.re) * sh);
+}
+
+// acos(w) = -j log(w + j sqrt(1 - w^2))
+static cpx c_acos(cpx w) {
+    cpx t = c_add(w, c_mul(cx(0, 1), c_sqrt(c_sub(cx(1, 0), c_mul(w, w)))));
+    return cx(ftr_atan2(t.im, t.re), -0.5f * ftr_log(c_abs2(t)));
+}
+// ----------------------------------------------------
+
+// --- Analog prototypes (conjugates listed explicitly) ---
+typedef struct {
+    int np, nz;
+    cpx p[MAX_ROOTS];
+    cpx z[MAX_ROOTS];
+    float h0;           // gain at DC relative to the passband peak
+} Proto;
+
+static float db_to_eps(float db) { return ftr_sqrt(ftr_exp(db * 0.23025851f) - 1.0f); } // sqrt(10^(db/10) - 1)
+static float asinh_f(float x) { return ftr_log(x + ftr_sqrt(x * x + 1.0f)); }
+
+static void push_pair(cpx* list, int* n, cpx r) {
+    list[(*n)++] = r;
+    if(r.im > REAL_TOL || r.im < -REAL_TOL) list[(*n)++] = cx(r.re, -r.im);
+}
+
+// Poles on an ellipse: -sinh(mu) sin(t) + j cosh(mu) cos(t), t = pi(2k+1)/(2N).
+static void cheby_poles(Proto* pr, int N, float eps, int invert) {
+    float mu = asinh_f(1.0f / eps) / (float)N;
+    float e = ftr_exp(mu), sh = 0.5f * (e - 1.0f / e), ch = 0.5f * (e + 1.0f / e);
+    pr->np = 0; pr->nz = 0;
+    for(int k=0; k<(N+1)/2; ++k){
+        float t = M_PI * (2.0f * k + 1.0f) / (2.0f * N);
+        cpx p = cx(-sh * ftr_sin(t), ch * ftr_cos(t));
+        if(2 * k + 1 == N) p.im = 0;
+        if(invert) p = c_div(cx(1, 0), cx(p.re, -p.im));
+        push_pair(pr->p, &pr->np, p);
+        if(invert && 2 * k + 1 != N) push_pair(pr->z, &pr->nz, cx(0, 1.0f / ftr_cos(t)));
+    }
+}
+
+static void proto_cheby1(Proto* pr, int N, float rp) {
+    float eps = db_to_eps(rp);
+    cheby_poles(pr, N, eps, 0);
+    pr->h0 = (N & 1) ? 1.0f : 1.0f / ftr_sqrt(1.0f + eps * eps);
+}
+
+// Inverse Chebyshev: stopband edge at 1 rad/s, zeros at j/cos(t).
+static void proto_cheby2(Proto* pr, int N, float rs) {
+    cheby_poles(pr, N, 1.0f / db_to_eps(rs), 1);
+    pr->h0 = 1.0f;
+}
+
+// Bessel poles normalized to -3 dB at 1 rad/s, orders 1..8, upper half plane.
+static const float bessel_poles[][2] = {
+    { -1.000000000f, 0.000000000f },                                    // 1
+    { -1.101601331f, 0.636009825f },                                    // 2
+    { -1.322675800f, 0.000000000f }, { -1.047409161f, 0.999264436f },   // 3
+    { -1.370067831f, 0.410249717f }, { -0.995208764f, 1.257105739f },   // 4
+    { -1.502316271f, 0.000000000f }, { -1.380877326f, 0.717909588f },   // 5
+    { -0.957676549f, 1.471124321f },
+    { -1.571490404f, 0.320896374f }, { -1.381858098f, 0.971471891f },   // 6
+    { -0.930656523f, 1.661863269f },
+    { -1.684368179f, 0.000000000f }, { -1.612038766f, 0.589244507f },   // 7
+    { -1.378903217f, 1.191566778f }, { -0.909867781f, 1.836451353f },
+    { -1.757408400f, 0.272867575f }, { -1.636939418f, 0.822795625f },   // 8
+    { -1.373841218f, 1.388356576f }, { -0.892869719f, 1.998325844f },
+};
+#define BESSEL_MAX_ORDER 8
+
+static void proto_bessel(Proto* pr, int N) {
+    int first = 0;
+    for(int m=1; m<N; ++m) first += (m + 1) / 2;
+    pr->np = 0; pr->nz = 0; pr->h0 = 1.0f;
+    for(int k=0; k<(N+1)/2; ++k)
+        push_pair(pr->p, &pr->np, cx(bessel_poles[first + k][0], bessel_poles[first + k][1]));
+}
+
+// Elliptic functions through descending Landen transformations (Orfanidis,
+// "Lecture notes on elliptic filter design"). v[] holds the moduli sequence;
+// carrying k' alongside k keeps the recursion exact for k close to 1.
+static void landen(float k, float kp, float* v) {
+    for(int n=0; n<LANDEN_STEPS; ++n){
+        float t = k / (1.0f + kp);
+        k = t * t;
+        kp = 2.0f * ftr_sqrt(kp) / (1.0f + kp);
+        v[n] = k;
+    }
+}
+
+static float ellipk(const float* v) {
+    float K = 0.5f * M_PI;
+    for(int n=0; n<LANDEN_STEPS; ++n) K *= 1.0f + v[n];
+    return K;
+}
+
+// cd(uK, k) and sn(uK, k) for complex u, by ascending from cos/sin(u pi/2).
+static cpx landen_up(cpx w, const float* v) {
+    for(int n=LANDEN_STEPS-1; n>=0; --n)
+        w = c_div(c_scale(w, 1.0f + v[n]), c_add(cx(1, 0), c_scale(c_mul(w, w), v[n])));
+    return w;
+}
+static cpx cde(cpx u, const float* v) { return landen_up(c_cos(c_scale(u, 0.5f * M_PI)), v); }
+static cpx sne(cpx u, const float* v) { return landen_up(c_sin(c_scale(u, 0.5f * M_PI)), v); }
+
+// Inverse of sne: u with sn(uK, k) = w.
+static cpx asne(cpx w, float k, const float* v) {
+    float prev = k;
+    for(int n=0; n<LANDEN_STEPS; ++n){
+        cpx d = c_add(cx(1, 0), c_sqrt(c_sub(cx(1, 0), c_scale(c_mul(w, w), prev * prev))));
+        w = c_scale(c_div(w, d), 2.0f / (1.0f + v[n]));
+        prev = v[n];
+    }
+    cpx u = c_scale(c_acos(w), 2.0f / M_PI);
+    return cx(1.0f - u.re, -u.im);
+}
+
+// Solves the degree equation N K'/K = K1'/K1 for k through the nome q.
+static float ellipdeg(int N, float k1, float k1p) {
+    float v[LANDEN_STEPS];
+    landen(k1, k1p, v);
+    float K1 = ellipk(v);
+    landen(k1p, k1, v);
+    float lnq = -M_PI * ellipk(v) / (K1 * (float)N);
+    float num = 0.0f, den = 1.0f;
+    for(int m=0; m<6; ++m) num += ftr_exp(lnq * (float)(m * (m + 1)));
+    for(int m=1; m<6; ++m) den += 2.0f * ftr_exp(lnq * (float)(m * m));
+    float r = num / den;
+    return 4.0f * ftr_exp(0.5f * lnq) * r * r;
+}
+
+static void proto_ellip(Proto* pr, int N, float rp, float rs) {
+    float ep = db_to_eps(rp), es = db_to_eps(rs);
+    float k1 = ep / es, k1p = ftr_sqrt((1.0f - k1) * (1.0f + k1));
+    float k = ellipdeg(N, k1, k1p), kp = ftr_sqrt((1.0f - k) * (1.0f + k));
+    float v[LANDEN_STEPS], v1[LANDEN_STEPS];
+    landen(k, kp, v);
+    landen(k1, k1p, v1);
+
+    // v0 = -j asne(j/ep, k1) / N
+    cpx a = asne(cx(0, 1.0f / ep), k1, v1);
+    cpx v0 = cx(a.im / (float)N, -a.re / (float)N);
+
+    pr->np = 0; pr->nz = 0;
+    for(int i=1; i<=N/2; ++i){
+        float u = (2.0f * i - 1.0f) / (float)N;
+        float zeta = cde(cx(u, 0), v).re;
+        push_pair(pr->z, &pr->nz, cx(0, 1.0f / (k * zeta)));
+        cpx c = cde(cx(u + v0.im, -v0.re), v);       // cde(u - j v0)
+        push_pair(pr->p, &pr->np, cx(-c.im, c.re));   // j * cde
+    }
+    if(N & 1){
+        cpx s = sne(cx(-v0.im, v0.re), v);            // sne(j v0)
+        push_pair(pr->p, &pr->np, cx(-s.im, 0));      // j * sne, real
+    }
+    pr->h0 = (N & 1) ? 1.0f : 1.0f / ftr_sqrt(1.0f + ep * ep);
+}
+// ----------------------------------------------------
+
+// --- Band mapping, bilinear transform and biquad pairing ---
+
+// Maps one prototype root (or infinity when inf != 0) to its digital roots.
+static int map_root(cpx r, int inf, int kind, float c, float B, float w0sq, cpx* out) {
+    switch (kind) {
+    case LOW_PASS:  out[0] = inf ? cx(-1, 0) : bilinear(c_scale(r, c)); return 1;
+    case HIGH_PASS: out[0] = inf ? cx(1, 0) : bilinear(c_div(cx(c, 0), r)); return 1;
+    default: break;
+    }
+    if(inf){
+        if(kind == BAND_PASS) { out[0] = cx(1, 0); out[1] = cx(-1, 0); }
+        else { float w0 = ftr_sqrt(w0sq); out[0] = bilinear(cx(0, w0)); out[1] = bilinear(cx(0, -w0)); }
+        return 2;
+    }
+    // s^2 - m s + w0^2 = 0 with m = r B (band-pass) or B / r (band-stop).
+    cpx m = (kind == BAND_PASS) ? c_scale(r, B) : c_div(cx(B, 0), r);
+    cpx d = c_sqrt(c_sub(c_mul(m, m), cx(4.0f * w0sq, 0)));
+    out[0] = bilinear(c_scale(c_add(m, d), 0.5f));
+    out[1] = bilinear(c_scale(c_sub(m, d), 0.5f));
+    return 2;
+}
+
+// Splits roots into conjugate pairs and real pairs (smallest with largest), with a
+// single real left over for odd counts. Returns the number of groups.
+static int group_roots(const cpx* r, int n, cpx g[][2], int* size) {
+    int used[MAX_ROOTS] = { 0 }, ng = 0;
+    float re[MAX_ROOTS];
+    int nr = 0;
+    for(int i=0; i<n; ++i){
+        if(used[i]) continue;
+        used[i] = 1;
+        if(r[i].im <= REAL_TOL && r[i].im >= -REAL_TOL) { re[nr++] = r[i].re; continue; }
+        int best = -1;
+        float bd = 0;
+        for(int j=0; j<n; ++j){
+            if(used[j]) continue;
+            float d = c_abs2(c_sub(r[j], cx(r[i].re, -r[i].im)));
+            if(best < 0 || d < bd) { best = j; bd = d; }
+        }
+        if(best >= 0) used[best] = 1;
+        g[ng][0] = cx(r[i].re, r[i].im < 0 ? -r[i].im : r[i].im);
+        g[ng][1] = cx(r[i].re, -g[ng][0].im);
+        size[ng++] = 2;
+    }
+    for(int i=1; i<nr; ++i)
+        for(int j=i; j>0 && re[j]<re[j-1]; --j) { float t = re[j]; re[j] = re[j-1]; re[j-1] = t; }
+    for(int a=0, b=nr-1; a<=b; ++a, --b){
+        g[ng][0] = cx(re[a], 0);
+        g[ng][1] = cx(re[b], 0);
+        size[ng++] = (a == b) ? 1 : 2;
+    }
+    return ng;
+}
+
+// |H(z)|^2 of sections 0..last at a point on the unit circle.
+static float cascade_gain2(const SOSCascade* f, int last, cpx z) {
+    cpx zi = cx(z.re, -z.im), zi2 = c_mul(zi, zi);
+    float g = 1.0f;
+    for(int i=0; i<=last; ++i){
+        cpx num = c_add(c_add(cx(f->b0[i], 0), c_scale(zi, f->b1[i])), c_scale(zi2, f->b2[i]));
+        cpx den = c_add(c_add(cx(1, 0), c_scale(zi, f->a1[i])), c_scale(zi2, f->a2[i]));
+        g *= c_abs2(num) / c_abs2(den);
+    }
+    return g;
+}
+
+// Peak |H|^2 of sections 0..last, searched on a uniform grid plus the angle of
+// every pole pair, where the narrow resonances of the cascade sit.
+static float cascade_peak2(const SOSCascade* f, int last) {
+    float peak = 0;
+    for(int k=0; k<=PEAK_GRID + f->n; ++k){
+        float w;
+        if(k <= PEAK_GRID) w = M_PI * (float)k / (float)PEAK_GRID;
+        else {
+            int i = k - PEAK_GRID - 1;
+            if(f->a2[i] <= 0) continue;
+            w = ftr_atan2(ftr_sqrt(4.0f * f->a2[i] - f->a1[i] * f->a1[i]), -f->a1[i]);
+        }
+        float g = cascade_gain2(f, last, cx(ftr_cos(w), ftr_sin(w)));
+        if(g > peak) peak = g;
+    }
+    return peak;
+}
+
+static void scale_numerator(SOSCascade* f, int i, float g) {
+    f->b0[i] *= g; f->b1[i] *= g; f->b2[i] *= g;
+}
+
+// Factor by which section i's numerator exceeds what the fixed-point kernels hold:
+// every coefficient below Q_COEF_LIMIT and the absolute sum below Q_SUM_LIMIT.
+static float numerator_excess(const SOSCascade* f, int i) {
+    float b0 = f->b0[i] < 0 ? -f->b0[i] : f->b0[i];
+    float b1 = f->b1[i] < 0 ? -f->b1[i] : f->b1[i];
+    float b2 = f->b2[i] < 0 ? -f->b2[i] : f->b2[i];
+    float a1 = f->a1[i] < 0 ? -f->a1[i] : f->a1[i];
+    float a2 = f->a2[i] < 0 ? -f->a2[i] : f->a2[i];
+    float m = b0 > b1 ? b0 : b1;
+    if(b2 > m) m = b2;
+    float e = m / (FIT_MARGIN * Q_COEF_LIMIT);
+    float es = (b0 + b1 + b2) / (FIT_MARGIN * Q_SUM_LIMIT - a1 - a2);
+    return es > e ? es : e;
+}
+
+static void design(SOSCascade* filter, const Proto* pr, int kind, FTR_PRECISION s, FTR_PRECISION f1, FTR_PRECISION f2) {
+    cpx pd[MAX_ROOTS], zd[MAX_ROOTS];
+    int np = 0, nz = 0;
+    float c = ftr_tan(M_PI * f1 / s), B = 0, w0sq = 0;
+    if(kind == BAND_PASS || kind == BAND_STOP){
+        float wu = ftr_tan(M_PI * f2 / s);
+        B = wu - c;
+        w0sq = c * wu;
+    }
+    for(int i=0; i<pr->np; ++i) np += map_root(pr->p[i], 0, kind, c, B, w0sq, pd + np);
+    for(int i=0; i<pr->nz; ++i) nz += map_root(pr->z[i], 0, kind, c, B, w0sq, zd + nz);
+    for(int i=pr->nz; i<pr->np; ++i) nz += map_root(cx(0, 0), 1, kind, c, B, w0sq, zd + nz);
+
+    cpx pg[MAX_ROOTS][2], zg[MAX_ROOTS][2];
+    int ps[MAX_ROOTS], zs[MAX_ROOTS], taken[MAX_ROOTS] = { 0 };
+    int n = group_roots(pd, np, pg, ps);
+    group_roots(zd, nz, zg, zs);
+
+    // Poles closest to the unit circle pick their nearest zeros first.
+    int order[MAX_ROOTS];
+    for(int i=0; i<n; ++i) order[i] = i;
+    for(int i=1; i<n; ++i)
+        for(int j=i; j>0 && c_abs2(pg[order[j]][0]) > c_abs2(pg[order[j-1]][0]); --j){
+            int t = order[j]; order[j] = order[j-1]; order[j-1] = t;
+        }
+
+    cpx zref = (kind == HIGH_PASS) ? cx(-1, 0) : (kind == BAND_PASS) ? bilinear(cx(0, ftr_sqrt(w0sq))) : cx(1, 0);
+    filter->n = n;
+    sos_reset(filter);
+    for(int k=0; k<n; ++k){
+        int i = order[k], best = -1;
+        float bd = 0;
+        for(int j=0; j<n; ++j){
+            if(taken[j] || zs[j] != ps[i]) continue;
+            float d = c_abs2(c_sub(zg[j][0], pg[i][0]));
+            float d2 = c_abs2(c_sub(zg[j][1], pg[i][0]));
+            if(d2 < d) d = d2;
+            if(best < 0 || d < bd) { best = j; bd = d; }
+        }
+        taken[best] = 1;
+        if(ps[i] == 2){
+            filter->a1[k] = -(pg[i][0].re + pg[i][1].re);
+            filter->a2[k] = c_mul(pg[i][0], pg[i][1]).re;
+            filter->b1[k] = -(zg[best][0].re + zg[best][1].re);
+            filter->b2[k] = c_mul(zg[best][0], zg[best][1]).re;
+        } else {
+            filter->a1[k] = -pg[i][0].re;
+            filter->a2[k] = 0;
+            filter->b1[k] = -zg[best][0].re;
+            filter->b2[k] = 0;
+        }
+        filter->b0[k] = 1.0f;
+    }
+
+    // Scale so the gain from the input to every section output peaks at 1: each
+    // section takes the headroom its predecessors leave, and the last one sets the
+    // passband exactly (h0 at zref), so no intermediate signal outgrows the input.
+    for(int k=0; k<n; ++k){
+        float g2 = (k == n - 1) ? cascade_gain2(filter, k, zref) / (pr->h0 * pr->h0)
+                                : cascade_peak2(filter, k);
+        scale_numerator(filter, k, 1.0f / ftr_sqrt(g2));
+    }
+
+    // A section that has to make up for a deep stopband ahead of it can need a
+    // numerator beyond the Q2.x range; it keeps what fits and hands the rest back
+    // to the sections before it. Section 0 takes whatever is left; if that breaks
+    // the range, the design does not fit and sos_quantize_q15/q31 reject it.
+    float carry = 1.0f;
+    for(int k=n-1; k>0; --k){
+        scale_numerator(filter, k, carry);
+        carry = numerator_excess(filter, k);
+        if(carry < 1.0f) carry = 1.0f;
+        scale_numerator(filter, k, 1.0f / carry);
+    }
+    scale_numerator(filter, 0, carry);
+}
+
+static int clamp_order(int order, int max) {
+    if(order < 1) return 1;
+    return order > max ? max : order;
+}
+// ----------------------------------------------------
+
+void init_cheby1_low_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rp) {
+    Proto pr; proto_cheby1(&pr, clamp_order(order, MAX_ROOTS), rp);
+    design(filter, &pr, LOW_PASS, s, f, 0);
+}
+void init_cheby1_high_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rp) {
+    Proto pr; proto_cheby1(&pr, clamp_order(order, MAX_ROOTS), rp);
+    design(filter, &pr, HIGH_PASS, s, f, 0);
+}
+void init_cheby1_band_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rp) {
+    Proto pr; proto_cheby1(&pr, clamp_order(order / 2, SOS_MAX_SECTIONS), rp);
+    design(filter, &pr, BAND_PASS, s, fl, fu);
+}
+void init_cheby1_band_stop(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rp) {
+    Proto pr; proto_cheby1(&pr, clamp_order(order / 2, SOS_MAX_SECTIONS), rp);
+    design(filter, &pr, BAND_STOP, s, fl, fu);
+}
+
+void init_cheby2_low_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rs) {
+    Proto pr; proto_cheby2(&pr, clamp_order(order, MAX_ROOTS), rs);
+    design(filter, &pr, LOW_PASS, s, f, 0);
+}
+void init_cheby2_high_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rs) {
+    Proto pr; proto_cheby2(&pr, clamp_order(order, MAX_ROOTS), rs);
+    design(filter, &pr, HIGH_PASS, s, f, 0);
+}
+void init_cheby2_band_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rs) {
+    Proto pr; proto_cheby2(&pr, clamp_order(order / 2, SOS_MAX_SECTIONS), rs);
+    design(filter, &pr, BAND_PASS, s, fl, fu);
+}
+void init_cheby2_band_stop(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rs) {
+    Proto pr; proto_cheby2(&pr, clamp_order(order / 2, SOS_MAX_SECTIONS), rs);
+    design(filter, &pr, BAND_STOP, s, fl, fu);
+}
+
+void init_bessel_low_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f) {
+    Proto pr; proto_bessel(&pr, clamp_order(clamp_order(order, MAX_ROOTS), BESSEL_MAX_ORDER));
+    design(filter, &pr, LOW_PASS, s, f, 0);
+}
+void init_bessel_high_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f) {
+    Proto pr; proto_bessel(&pr, clamp_order(clamp_order(order, MAX_ROOTS), BESSEL_MAX_ORDER));
+    design(filter, &pr, HIGH_PASS, s, f, 0);
+}
+void init_bessel_band_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu) {
+    Proto pr; proto_bessel(&pr, clamp_order(clamp_order(order / 2, SOS_MAX_SECTIONS), BESSEL_MAX_ORDER));
+    design(filter, &pr, BAND_PASS, s, fl, fu);
+}
+void init_bessel_band_stop(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu) {
+    Proto pr; proto_bessel(&pr, clamp_order(clamp_order(order / 2, SOS_MAX_SECTIONS), BESSEL_MAX_ORDER));
+    design(filter, &pr, BAND_STOP, s, fl, fu);
+}
+
+void init_ellip_low_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rp, FTR_PRECISION rs) {
+    Proto pr; proto_ellip(&pr, clamp_order(order, MAX_ROOTS), rp, rs);
+    design(filter, &pr, LOW_PASS, s, f, 0);
+}
+void init_ellip_high_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION rp, FTR_PRECISION rs) {
+    Proto pr; proto_ellip(&pr, clamp_order(order, MAX_ROOTS), rp, rs);
+    design(filter, &pr, HIGH_PASS, s, f, 0);
+}
+void init_ellip_band_pass(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rp, FTR_PRECISION rs) {
+    Proto pr; proto_ellip(&pr, clamp_order(order / 2, SOS_MAX_SECTIONS), rp, rs);
+    design(filter, &pr, BAND_PASS, s, fl, fu);
+}
+void init_ellip_band_stop(SOSCascade* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu, FTR_PRECISION rp, FTR_PRECISION rs) {
+    Proto pr; proto_ellip(&pr, clamp_order(order / 2, SOS_MAX_SECTIONS), rp, rs);
+    design(filter, &pr, BAND_STOP, s, fl, fu);
+}
+
+// --- Notch and harmonic comb ---
+
+// a2 = (1 - tan(bw/2)) / (1 + tan(bw/2)) puts the -3 dB points exactly bw apart.
+static void notch_section(SOSCascade* filter, int i, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION q) {
+    FTR_PRECISION c = ftr_cos(2.0f * M_PI * f / s);
+    FTR_PRECISION alpha = ftr_tan(M_PI * f / (q * s));
+    FTR_PRECISION g = 1.0f / (1.0f + alpha);
+    filter->b0[i] = g;
+    filter->b1[i] = -2.0f * c * g;
+    filter->b2[i] = g;
+    filter->a1[i] = -2.0f * c * g;
+    filter->a2[i] = (1.0f - alpha) * g;
+}
+
+void init_notch(SOSCascade* filter, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION q) {
+    filter->n = 1;
+    notch_section(filter, 0, s, f, q);
+    sos_reset(filter);
+}
+
+void init_notch_comb(SOSCascade* filter, FTR_PRECISION s, FTR_PRECISION f, int harmonics, FTR_PRECISION q) {
+    int n = 0;
+    harmonics = clamp_order(harmonics, SOS_MAX_SECTIONS);
+    for(int k=1; k<=harmonics && (FTR_PRECISION)k * f < 0.5f * s; k++)
+        notch_section(filter, n++, s, (FTR_PRECISION)k * f, (FTR_PRECISION)k * q);
+    filter->n = n;
+    sos_reset(filter);
+}
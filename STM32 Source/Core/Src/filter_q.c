@@ -0,0 +1,338 @@
+#include "filter_q.h"
+
+#define Q15_ROUND       (1L << (Q15_COEF_FRAC - 1))
+#define Q31_ROUND       (1LL << (Q31_COEF_FRAC - 1))
+
+// Round-to-nearest quantizer with clamping, used only at init time. The gains it
+// clamps are bounded by design; sos_quantize_* check SOS coefficients first.
+static int32_t quantize(FTR_PRECISION v, int frac, int32_t lo, int32_t hi) {
+    FTR_PRECISION scaled = v * (FTR_PRECISION)(1UL << frac);
+    scaled += (scaled < 0) ? -0.5f : 0.5f;
+    if (scaled >= (FTR_PRECISION)hi) return hi;
+    if (scaled <= (FTR_PRECISION)lo) return lo;
+    return (int32_t)scaled;
+}
+
+static q15_t q15_coef(FTR_PRECISION v, int frac) { return (q15_t)quantize(v, frac, INT16_MIN, INT16_MAX); }
+static q31_t q31_coef(FTR_PRECISION v, int frac) { return (q31_t)quantize(v, frac, INT32_MIN, INT32_MAX); }
+
+// Nonzero if a coefficient is outside +-Q_COEF_LIMIT, where quantize() would clamp.
+static int sos_out_of_range(const SOSCascade* ref) {
+    for(int i=0; i < ref->n; ++i){
+        FTR_PRECISION c[5] = { ref->b0[i], ref->b1[i], ref->b2[i], ref->a1[i], ref->a2[i] };
+        for(int k=0; k<5; k++)
+            if(!(c[k] < Q_COEF_LIMIT && c[k] > -Q_COEF_LIMIT)) return 1; // also catches NaN
+    }
+    return 0;
+}
+
+// The kernels need the rounded |b0|+|b1|+|b2|+|a1|+|a2| below Q_SUM_LIMIT.
+static int64_t abs_sum(int64_t b0, int64_t b1, int64_t b2, int64_t a1, int64_t a2) {
+    return (b0 < 0 ? -b0 : b0) + (b1 < 0 ? -b1 : b1) + (b2 < 0 ? -b2 : b2)
+         + (a1 < 0 ? -a1 : a1) + (a2 < 0 ? -a2 : a2);
+}
+
+#if MAX_SECTIONS > 2
+#error "LPF/HPF output gain G needs more integer bits for MAX_SECTIONS > 2"
+#endif
+
+// Smallest k with A*2^k >= 1, capped at frac; returns frac-k and folds A*2^k into *G.
+static uint8_t gain_shift(FTR_PRECISION A, int frac, FTR_PRECISION* G) {
+    int k = 0;
+    while (A < 1.0f && k < frac) { A *= 2.0f; k++; }
+    *G *= A;
+    return (uint8_t)(frac - k);
+}
+
+// Steady-state priming: each DF-I section settles to x1 = x2 = u and y1 = y2 = y, with
+// y*(1 - feedback) = numerator DC sum * u evaluated with the quantized coefficients.
+static int64_t div_round(int64_t num, int64_t den) {
+    return num >= 0 ? (num + den / 2) / den : -((-num + den / 2) / den);
+}
+
+// --- Q15 designers ---
+
+static void quantize_biquad_q15(BWLowPassQ15* filter, const BWLowPass* ref) {
+    filter->n = ref->n;
+    for(int k=0; k<MAX_SECTIONS; k++) { filter->x1[k]=0; filter->x2[k]=0; filter->y1[k]=0; filter->y2[k]=0; }
+
+    FTR_PRECISION G = 1.0f;
+    for(int i=0; i < filter->n; ++i){
+        filter->sh[i] = gain_shift(ref->A[i], Q15_COEF_FRAC, &G);
+        filter->d1[i] = q15_coef(ref->d1[i], Q15_COEF_FRAC);
+        filter->d2[i] = q15_coef(ref->d2[i], Q15_COEF_FRAC);
+    }
+    filter->G = q15_coef(G, Q15_COEF_FRAC);
+}
+
+void init_bw_low_pass_q15(BWLowPassQ15* filter, int order, FTR_PRECISION s, FTR_PRECISION f) {
+    BWLowPass ref;
+    init_bw_low_pass(&ref, order, s, f);
+    quantize_biquad_q15(filter, &ref);
+}
+
+void init_bw_high_pass_q15(BWHighPassQ15* filter, int order, FTR_PRECISION s, FTR_PRECISION f) {
+    BWHighPass ref;
+    init_bw_high_pass(&ref, order, s, f);
+    quantize_biquad_q15(filter, &ref);
+}
+
+int sos_quantize_q15(SOSCascadeQ15* filter, const SOSCascade* ref) {
+    filter->n = 0;
+    for(int k=0; k<SOS_MAX_SECTIONS; k++) { filter->x1[k]=0; filter->x2[k]=0; filter->y1[k]=0; filter->y2[k]=0; }
+    if(sos_out_of_range(ref)) return -1;
+
+    for(int i=0; i < ref->n; ++i){
+        filter->b0[i] = q15_coef(ref->b0[i], Q15_COEF_FRAC);
+        filter->b1[i] = q15_coef(ref->b1[i], Q15_COEF_FRAC);
+        filter->b2[i] = q15_coef(ref->b2[i], Q15_COEF_FRAC);
+        filter->a1[i] = q15_coef(ref->a1[i], Q15_COEF_FRAC);
+        filter->a2[i] = q15_coef(ref->a2[i], Q15_COEF_FRAC);
+        if(abs_sum(filter->b0[i], filter->b1[i], filter->b2[i], filter->a1[i], filter->a2[i])
+           >= (int64_t)Q_SUM_LIMIT << Q15_COEF_FRAC) return -1;
+    }
+    filter->n = ref->n;
+    return 0;
+}
+
+void init_bw_band_pass_q15(BWBandPassQ15* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu) {
+    BWBandPass ref;
+    init_bw_band_pass(&ref, order, s, fl, fu);
+    sos_quantize_q15(filter, &ref);
+}
+
+void init_bw_band_stop_q15(BWBandStopQ15* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu) {
+    BWBandStop ref;
+    init_bw_band_stop(&ref, order, s, fl, fu);
+    sos_quantize_q15(filter, &ref);
+}
+
+static void prime_biquad_q15(BWLowPassQ15* filter, q15_t x, int high) {
+    for(int i=0; i<filter->n; ++i){
+        q15_t y = 0;
+        if(!high) y = q15_sat((int32_t)div_round((int64_t)((uint64_t)((int64_t)4 * x) << filter->sh[i]),
+                              (1L << Q15_COEF_FRAC) - filter->d1[i] - filter->d2[i]));
+        filter->x1[i] = x; filter->x2[i] = x;
+        filter->y1[i] = y; filter->y2[i] = y;
+        x = y;
+    }
+}
+
+void bw_low_pass_prime_q15(BWLowPassQ15* filter, q15_t x) { prime_biquad_q15(filter, x, 0); }
+void bw_high_pass_prime_q15(BWHighPassQ15* filter, q15_t x) { prime_biquad_q15(filter, x, 1); }
+
+void sos_prime_q15(SOSCascadeQ15* filter, q15_t x) {
+    for(int i=0; i<filter->n; ++i){
+        int64_t b = (int64_t)filter->b0[i] + filter->b1[i] + filter->b2[i];
+        q15_t y = q15_sat((int32_t)div_round(b * x, (1L << Q15_COEF_FRAC) + filter->a1[i] + filter->a2[i]));
+        filter->x1[i] = x; filter->x2[i] = x;
+        filter->y1[i] = y; filter->y2[i] = y;
+        x = y;
+    }
+}
+
+void bw_band_pass_prime_q15(BWBandPassQ15* filter, q15_t x) { sos_prime_q15(filter, x); }
+void bw_band_stop_prime_q15(BWBandStopQ15* filter, q15_t x) { sos_prime_q15(filter, x); }
+
+// --- Q31 designers ---
+
+static void quantize_biquad_q31(BWLowPassQ31* filter, const BWLowPass* ref) {
+    filter->n = ref->n;
+    for(int k=0; k<MAX_SECTIONS; k++) { filter->x1[k]=0; filter->x2[k]=0; filter->y1[k]=0; filter->y2[k]=0; }
+
+    FTR_PRECISION G = 1.0f;
+    for(int i=0; i < filter->n; ++i){
+        filter->sh[i] = gain_shift(ref->A[i], Q31_COEF_FRAC, &G);
+        filter->d1[i] = q31_coef(ref->d1[i], Q31_COEF_FRAC);
+        filter->d2[i] = q31_coef(ref->d2[i], Q31_COEF_FRAC);
+    }
+    filter->G = q31_coef(G, Q31_COEF_FRAC);
+}
+
+void init_bw_low_pass_q31(BWLowPassQ31* filter, int order, FTR_PRECISION s, FTR_PRECISION f) {
+    BWLowPass ref;
+    init_bw_low_pass(&ref, order, s, f);
+    quantize_biquad_q31(filter, &ref);
+}
+
+void init_bw_high_pass_q31(BWHighPassQ31* filter, int order, FTR_PRECISION s, FTR_PRECISION f) {
+    BWHighPass ref;
+    init_bw_high_pass(&ref, order, s, f);
+    quantize_biquad_q31(filter, &ref);
+}
+
+int sos_quantize_q31(SOSCascadeQ31* filter, const SOSCascade* ref) {
+    filter->n = 0;
+    for(int k=0; k<SOS_MAX_SECTIONS; k++) { filter->x1[k]=0; filter->x2[k]=0; filter->y1[k]=0; filter->y2[k]=0; }
+    if(sos_out_of_range(ref)) return -1;
+
+    for(int i=0; i < ref->n; ++i){
+        filter->b0[i] = q31_coef(ref->b0[i], Q31_COEF_FRAC);
+        filter->b1[i] = q31_coef(ref->b1[i], Q31_COEF_FRAC);
+        filter->b2[i] = q31_coef(ref->b2[i], Q31_COEF_FRAC);
+        filter->a1[i] = q31_coef(ref->a1[i], Q31_COEF_FRAC);
+        filter->a2[i] = q31_coef(ref->a2[i], Q31_COEF_FRAC);
+        if(abs_sum(filter->b0[i], filter->b1[i], filter->b2[i], filter->a1[i], filter->a2[i])
+           >= (int64_t)Q_SUM_LIMIT << Q31_COEF_FRAC) return -1;
+    }
+    filter->n = ref->n;
+    return 0;
+}
+
+void init_bw_band_pass_q31(BWBandPassQ31* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu) {
+    BWBandPass ref;
+    init_bw_band_pass(&ref, order, s, fl, fu);
+    sos_quantize_q31(filter, &ref);
+}
+
+void init_bw_band_stop_q31(BWBandStopQ31* filter, int order, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu) {
+    BWBandStop ref;
+    init_bw_band_stop(&ref, order, s, fl, fu);
+    sos_quantize_q31(filter, &ref);
+}
+
+static void prime_biquad_q31(BWLowPassQ31* filter, q31_t x, int high) {
+    for(int i=0; i<filter->n; ++i){
+        q31_t y = 0;
+        if(!high) y = q31_sat(div_round((int64_t)((uint64_t)((int64_t)4 * x) << filter->sh[i]),
+                              (1LL << Q31_COEF_FRAC) - filter->d1[i] - filter->d2[i]));
+        filter->x1[i] = x; filter->x2[i] = x;
+        filter->y1[i] = y; filter->y2[i] = y;
+        x = y;
+    }
+}
+
+void bw_low_pass_prime_q31(BWLowPassQ31* filter, q31_t x) { prime_biquad_q31(filter, x, 0); }
+void bw_high_pass_prime_q31(BWHighPassQ31* filter, q31_t x) { prime_biquad_q31(filter, x, 1); }
+
+void sos_prime_q31(SOSCascadeQ31* filter, q31_t x) {
+    for(int i=0; i<filter->n; ++i){
+        int64_t b = (int64_t)filter->b0[i] + filter->b1[i] + filter->b2[i];
+        q31_t y = q31_sat(div_round(b * x, (1LL << Q31_COEF_FRAC) + filter->a1[i] + filter->a2[i]));
+        filter->x1[i] = x; filter->x2[i] = x;
+        filter->y1[i] = y; filter->y2[i] = y;
+        x = y;
+    }
+}
+
+void bw_band_pass_prime_q31(BWBandPassQ31* filter, q31_t x) { sos_prime_q31(filter, x); }
+void bw_band_stop_prime_q31(BWBandStopQ31* filter, q31_t x) { sos_prime_q31(filter, x); }
+
+// --- Q15 kernels ---
+// Worst case for LPF/HPF: 4*2^-k + |d1| + |d2| <= 7 in Q2.13 times Q15 data < 2^31.
+
+q15_t bw_low_pass_q15(BWLowPassQ15* filter, q15_t x){
+    for(int i=0; i<filter->n; ++i){
+        int32_t num = (int32_t)x + 2 * (int32_t)filter->x1[i] + filter->x2[i];
+        int32_t acc = (int32_t)((uint32_t)num << filter->sh[i])
+                    + (int32_t)filter->d1[i] * filter->y1[i]
+                    + (int32_t)filter->d2[i] * filter->y2[i];
+        q15_t y = q15_sat((acc + Q15_ROUND) >> Q15_COEF_FRAC);
+        filter->x2[i] = filter->x1[i];
+        filter->x1[i] = x;
+        filter->y2[i] = filter->y1[i];
+        filter->y1[i] = y;
+        x = y;
+    }
+    return q15_sat(((int32_t)filter->G * x + Q15_ROUND) >> Q15_COEF_FRAC);
+}
+
+q15_t bw_high_pass_q15(BWHighPassQ15* filter, q15_t x){
+    for(int i=0; i<filter->n; ++i){
+        int32_t num = (int32_t)x - 2 * (int32_t)filter->x1[i] + filter->x2[i];
+        int32_t acc = (int32_t)((uint32_t)num << filter->sh[i])
+                    + (int32_t)filter->d1[i] * filter->y1[i]
+                    + (int32_t)filter->d2[i] * filter->y2[i];
+        q15_t y = q15_sat((acc + Q15_ROUND) >> Q15_COEF_FRAC);
+        filter->x2[i] = filter->x1[i];
+        filter->x1[i] = x;
+        filter->y2[i] = filter->y1[i];
+        filter->y1[i] = y;
+        x = y;
+    }
+    return q15_sat(((int32_t)filter->G * x + Q15_ROUND) >> Q15_COEF_FRAC);
+}
+
+q15_t sos_cascade_q15(SOSCascadeQ15* filter, q15_t x){
+    for(int i=0; i<filter->n; ++i){
+        int32_t acc = (int32_t)filter->b0[i] * x
+                    + (int32_t)filter->b1[i] * filter->x1[i]
+                    + (int32_t)filter->b2[i] * filter->x2[i]
+                    - (int32_t)filter->a1[i] * filter->y1[i]
+                    - (int32_t)filter->a2[i] * filter->y2[i];
+        q15_t y = q15_sat((acc + Q15_ROUND) >> Q15_COEF_FRAC);
+        filter->x2[i] = filter->x1[i];
+        filter->x1[i] = x;
+        filter->y2[i] = filter->y1[i];
+        filter->y1[i] = y;
+        x = y;
+    }
+    return x;
+}
+
+q15_t bw_band_pass_q15(BWBandPassQ15* filter, q15_t x){
+    return sos_cascade_q15(filter, x);
+}
+
+q15_t bw_band_stop_q15(BWBandStopQ15* filter, q15_t x){
+    return sos_cascade_q15(filter, x);
+}
+
+// --- Q31 kernels ---
+
+q31_t bw_low_pass_q31(BWLowPassQ31* filter, q31_t x){
+    for(int i=0; i<filter->n; ++i){
+        int64_t num = (int64_t)x + 2 * (int64_t)filter->x1[i] + filter->x2[i];
+        int64_t acc = (int64_t)((uint64_t)num << filter->sh[i])
+                    + (int64_t)filter->d1[i] * filter->y1[i]
+                    + (int64_t)filter->d2[i] * filter->y2[i];
+        q31_t y = q31_sat((acc + Q31_ROUND) >> Q31_COEF_FRAC);
+        filter->x2[i] = filter->x1[i];
+        filter->x1[i] = x;
+        filter->y2[i] = filter->y1[i];
+        filter->y1[i] = y;
+        x = y;
+    }
+    return q31_sat(((int64_t)filter->G * x + Q31_ROUND) >> Q31_COEF_FRAC);
+}
+
+q31_t bw_high_pass_q31(BWHighPassQ31* filter, q31_t x){
+    for(int i=0; i<filter->n; ++i){
+        int64_t num = (int64_t)x - 2 * (int64_t)filter->x1[i] + filter->x2[i];
+        int64_t acc = (int64_t)((uint64_t)num << filter->sh[i])
+                    + (int64_t)filter->d1[i] * filter->y1[i]
+                    + (int64_t)filter->d2[i] * filter->y2[i];
+        q31_t y = q31_sat((acc + Q31_ROUND) >> Q31_COEF_FRAC);
+        filter->x2[i] = filter->x1[i];
+        filter->x1[i] = x;
+        filter->y2[i] = filter->y1[i];
+        filter->y1[i] = y;
+        x = y;
+    }
+    return q31_sat(((int64_t)filter->G * x + Q31_ROUND) >> Q31_COEF_FRAC);
+}
+
+q31_t sos_cascade_q31(SOSCascadeQ31* filter, q31_t x){
+    for(int i=0; i<filter->n; ++i){
+        int64_t acc = (int64_t)filter->b0[i] * x
+                    + (int64_t)filter->b1[i] * filter->x1[i]
+                    + (int64_t)filter->b2[i] * filter->x2[i]
+                    - (int64_t)filter->a1[i] * filter->y1[i]
+                    - (int64_t)filter->a2[i] * filter->y2[i];
+        q31_t y = q31_sat((acc + Q31_ROUND) >> Q31_COEF_FRAC);
+        filter->x2[i] = filter->x1[i];
+        filter->x1[i] = x;
+        filter->y2[i] = filter->y1[i];
+        filter->y1[i] = y;
+        x = y;
+    }
+    return x;
+}
+
+q31_t bw_band_pass_q31(BWBandPassQ31* filter, q31_t x){
+    return sos_cascade_q31(filter, x);
+}
+
+q31_t bw_band_stop_q31(BWBandStopQ31* filter, q31_t x){
+    return sos_cascade_q31(filter, x);
+}
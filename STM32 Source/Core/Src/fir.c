@@ -0,0 +1,146 @@
+#include "fir.h"
+
+#define FIR_MASK (FIR_MAX_TAPS - 1)
+
+// --- Designers ---
+
+void fir_reset(FIRFilter* filter) {
+    filter->pos = 0;
+    for(int k=0; k<2*FIR_MAX_TAPS; k++) filter->hist[k] = 0;
+}
+
+void init_fir(FIRFilter* filter, const FTR_PRECISION* h, int taps) {
+    if(taps < 1) taps = 1;
+    if(taps > FIR_MAX_TAPS) taps = FIR_MAX_TAPS;
+    filter->taps = taps;
+    filter->symmetric = 1;
+    for(int k=0; k<taps; k++) {
+        filter->h[k] = h[k];
+        if(h[k] != h[taps-1-k]) filter->symmetric = 0;
+    }
+    fir_reset(filter);
+}
+
+// Hamming-windowed sinc with cutoff f, built from the first half and mirrored so the
+// result is exactly symmetric. 'sign' is +1 or -1 to add or subtract into h.
+static void windowed_sinc(FTR_PRECISION* h, int taps, FTR_PRECISION s, FTR_PRECISION f, FTR_PRECISION sign) {
+    FTR_PRECISION fc = 2.0f * f / s;
+    FTR_PRECISION mid = 0.5f * (FTR_PRECISION)(taps - 1);
+    for(int k=0; k<(taps+1)/2; k++){
+        FTR_PRECISION m = (FTR_PRECISION)k - mid;
+        FTR_PRECISION v = (m == 0.0f) ? fc : ftr_sin(M_PI * fc * m) / (M_PI * m);
+        if(taps > 1) v *= 0.54f - 0.46f * ftr_cos(2.0f * M_PI * (FTR_PRECISION)k / (FTR_PRECISION)(taps - 1));
+        h[k] += sign * v;
+        if(k != taps-1-k) h[taps-1-k] += sign * v;
+    }
+}
+
+// Scales h so its response at frequency f is 1 (cos sum, valid for symmetric h).
+static void normalize(FTR_PRECISION* h, int taps, FTR_PRECISION s, FTR_PRECISION f) {
+    FTR_PRECISION mid = 0.5f * (FTR_PRECISION)(taps - 1), g = 0;
+    for(int k=0; k<taps; k++) g += h[k] * ftr_cos(2.0f * M_PI * f * ((FTR_PRECISION)k - mid) / s);
+    if(g != 0.0f) for(int k=0; k<taps; k++) h[k] /= g;
+}
+
+static int clamp_taps(int taps) {
+    if(taps < 1) return 1;
+    return taps > FIR_MAX_TAPS ? FIR_MAX_TAPS : taps;
+}
+
+void init_fir_low_pass(FIRFilter* filter, int taps, FTR_PRECISION s, FTR_PRECISION f) {
+    FTR_PRECISION h[FIR_MAX_TAPS] = { 0 };
+    taps = clamp_taps(taps);
+    windowed_sinc(h, taps, s, f, 1.0f);
+    normalize(h, taps, s, 0.0f);
+    init_fir(filter, h, taps);
+}
+
+// Spectral inversion of the low-pass; needs an odd length for the centre tap.
+void init_fir_high_pass(FIRFilter* filter, int taps, FTR_PRECISION s, FTR_PRECISION f) {
+    FTR_PRECISION h[FIR_MAX_TAPS] = { 0 };
+    taps = clamp_taps(taps | 1);
+    if(taps > FIR_MAX_TAPS - 1) taps = FIR_MAX_TAPS - 1;
+    windowed_sinc(h, taps, s, f, 1.0f);
+    normalize(h, taps, s, 0.0f);
+    for(int k=0; k<taps; k++) h[k] = -h[k];
+    h[taps/2] += 1.0f;
+    normalize(h, taps, s, 0.5f * s);
+    init_fir(filter, h, taps);
+}
+
+void init_fir_band_pass(FIRFilter* filter, int taps, FTR_PRECISION s, FTR_PRECISION fl, FTR_PRECISION fu) {
+    FTR_PRECISION h[FIR_MAX_TAPS] = { 0 };
+    taps = clamp_taps(taps);
+    windowed_sinc(h, taps, s, fu, 1.0f);
+    windowed_sinc(h, taps, s, fl, -1.0f);
+    normalize(h, taps, s, 0.5f * (fl + fu));
+    init_fir(filter, h, taps);
+}
+
+void fir_reset_q15(FIRFilterQ15* filter) {
+    filter->pos = 0;
+    for(int k=0; k<2*FIR_MAX_TAPS; k++) filter->hist[k] = 0;
+}
+
+void fir_quantize_q15(FIRFilterQ15* filter, const FIRFilter* ref) {
+    filter->taps = ref->taps;
+    filter->symmetric = ref->symmetric;
+    for(int k=0; k<ref->taps; k++){
+        FTR_PRECISION v = ref->h[k] * 32768.0f;
+        v += (v < 0) ? -0.5f : 0.5f;
+        filter->h[k] = (v >= 32767.0f) ? INT16_MAX : (v <= -32767.0f) ? -INT16_MAX : (q15_t)v; // keeps h*(a+b) in 32 bits
+    }
+    fir_reset_q15(filter);
+}
+
+// --- Kernels ---
+// The newest sample goes to hist[pos] and its mirror hist[pos + FIR_MAX_TAPS], so
+// w = hist + pos holds x[n], x[n-1], ... x[n-taps+1] contiguously.
+
+FTR_PRECISION fir_filter(FIRFilter* filter, FTR_PRECISION x){
+    int pos = (filter->pos - 1) & FIR_MASK;
+    filter->pos = pos;
+    filter->hist[pos] = x;
+    filter->hist[pos + FIR_MAX_TAPS] = x;
+
+    const FTR_PRECISION* w = filter->hist + pos;
+    const FTR_PRECISION* h = filter->h;
+    int n = filter->taps;
+    FTR_PRECISION acc = 0;
+    if(filter->symmetric){
+        int half = n / 2;
+        for(int k=0; k<half; k++) acc += h[k] * (w[k] + w[n-1-k]);
+        if(n & 1) acc += h[half] * w[half];
+    } else {
+        for(int k=0; k<n; k++) acc += h[k] * w[k];
+    }
+    return acc;
+}
+
+q15_t fir_filter_q15(FIRFilterQ15* filter, q15_t x){
+    int pos = (filter->pos - 1) & FIR_MASK;
+    filter->pos = pos;
+    filter->hist[pos] = x;
+    filter->hist[pos + FIR_MAX_TAPS] = x;
+
+    const q15_t* w = filter->hist + pos;
+    const q15_t* h = filter->h;
+    int n = filter->taps;
+    int64_t acc = 1 << 14;
+    if(filter->symmetric){
+        int half = n / 2;
+        for(int k=0; k<half; k++) acc += (int32_t)h[k] * ((int32_t)w[k] + w[n-1-k]);
+        if(n & 1) acc += (int32_t)h[half] * w[half];
+    } else {
+        for(int k=0; k<n; k++) acc += (int32_t)h[k] * w[k];
+    }
+    return q15_sat((int32_t)(acc >> 15)); // |acc| < 2^35 for 32 taps
+}
+
+void fir_filter_block(FIRFilter* filter, const FTR_PRECISION* in, FTR_PRECISION* out, int n){
+    for(int k=0; k<n; k++) out[k] = fir_filter(filter, in[k]);
+}
+
+void fir_filter_block_q15(FIRFilterQ15* filter, const q15_t* in, q15_t* out, int n){
+    for(int k=0; k<n; k++) out[k] = fir_filter_q15(filter, in[k]);
+}
@@ -0,0 +1,94 @@
+#include "goertzel.h"
+
+void goertzel_reset(GoertzelBank* g) {
+    g->count = 0;
+    g->pos = 0;
+    for(int i=0; i<GOERTZEL_MAX_TONES; i++) { g->s1[i] = 0; g->s2[i] = 0; g->amp[i] = 0; }
+    if(g->history) for(int k=0; k<g->window; k++) g->history[k] = 0;
+}
+
+// 2cos(w) = 2 - 4 sin^2(w/2) keeps the low-frequency coefficients exact to Q2.29;
+// float cos() near 1 only resolves 2^-24.
+void init_goertzel(GoertzelBank* g, FTR_PRECISION s, const FTR_PRECISION* freqs, int tones, int window, int hop, int16_t* history) {
+    if(tones < 0) tones = 0;
+    if(tones > GOERTZEL_MAX_TONES) tones = GOERTZEL_MAX_TONES;
+    if(window < 1) window = 1;
+    if(window > GOERTZEL_MAX_WINDOW) window = GOERTZEL_MAX_WINDOW;
+    if(hop < 1) hop = 1;
+    if(!history) hop = window > hop ? window : hop;
+    g->tones = tones;
+    g->window = window;
+    g->hop = hop;
+    g->history = (hop < window) ? history : 0;
+    for(int i=0; i<tones; i++){
+        FTR_PRECISION h = M_PI * freqs[i] / s, sn;
+        if(h < 0.0f) h = -h;
+        // Series below 0.1: the table sine's absolute error dominates there.
+        sn = (h < 0.1f) ? h * (1.0f - h * h / 6.0f * (1.0f - h * h / 20.0f)) : ftr_sin(h);
+        g->coef[i] = (int32_t)(((int64_t)1 << 30) - (int64_t)(sn * sn * 2147483648.0f + 0.5f));
+    }
+    goertzel_reset(g);
+}
+
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t r = 0, bit = (uint64_t)1 << 62;
+    while(bit > v) bit >>= 2;
+    while(bit){
+        if(v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; }
+        else r >>= 1;
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+static inline void resonate(GoertzelBank* g, int i, int32_t x) {
+    int32_t s0 = x + (int32_t)(((int64_t)g->coef[i] * g->s1[i]) >> GOERTZEL_COEF_FRAC) - g->s2[i];
+    g->s2[i] = g->s1[i];
+    g->s1[i] = s0;
+}
+
+// |X|^2 = s1^2 + s2^2 - 2cos(w) s1 s2; amplitude = 2 |X| / window, rounded.
+static void finish_frame(GoertzelBank* g) {
+    for(int i=0; i<g->tones; i++){
+        int64_t s1 = g->s1[i], s2 = g->s2[i];
+        int64_t p = s1 * s1 + s2 * s2 - ((g->coef[i] * s1) >> GOERTZEL_COEF_FRAC) * s2;
+        uint32_t a = (2 * isqrt64(p < 0 ? 0 : (uint64_t)p) + (uint32_t)g->window / 2) / (uint32_t)g->window;
+        g->amp[i] = a > UINT16_MAX ? UINT16_MAX : (uint16_t)a;
+        g->s1[i] = 0;
+        g->s2[i] = 0;
+    }
+}
+
+int goertzel_update(GoertzelBank* g, int16_t x){
+    if(g->history){
+        g->history[g->pos] = x;
+        if(++g->pos == g->window) g->pos = 0;
+        if(++g->count < g->hop) return 0;
+        g->count = 0;
+        // Oldest first: pos now points at the oldest entry.
+        for(int i=0; i<g->tones; i++){
+            int k = g->pos;
+            for(int n=0; n<g->window; n++){
+                resonate(g, i, g->history[k]);
+                if(++k == g->window) k = 0;
+            }
+        }
+        finish_frame(g);
+        return 1;
+    }
+
+    // Blocked: samples past the window (hop > window) are skipped.
+    int done = 0;
+    if(g->count < g->window){
+        for(int i=0; i<g->tones; i++) resonate(g, i, x);
+        if(g->count + 1 == g->window) { finish_frame(g); done = 1; }
+    }
+    if(++g->count >= g->hop) g->count = 0;
+    return done;
+}
+
+int goertzel_update_block(GoertzelBank* g, const int16_t* in, int n){
+    int frames = 0;
+    for(int k=0; k<n; k++) frames += goertzel_update(g, in[k]);
+    return frames;
+}
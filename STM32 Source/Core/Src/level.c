@@ -0,0 +1,112 @@
+#include "level.h"
+
+// Nearest k with 2^k ~ t * s, clamped to 0..15.
+static uint8_t time_shift(FTR_PRECISION s, FTR_PRECISION t) {
+    FTR_PRECISION n = t * s;
+    uint8_t k = 0;
+    while(k < 15 && (FTR_PRECISION)(1u << k) * 1.41421356f < n) k++;
+    return k;
+}
+
+static inline uint32_t magnitude(int16_t x) { return (uint32_t)(x < 0 ? -(int32_t)x : x) << 16; }
+
+static inline uint16_t round16(uint32_t v) {
+    v = (v >> 16) + ((v >> 15) & 1);
+    return v > UINT16_MAX ? UINT16_MAX : (uint16_t)v;
+}
+
+// --- Envelope ---
+
+void envelope_reset(EnvelopeFollower* e) { e->env = 0; }
+
+void init_envelope(EnvelopeFollower* e, FTR_PRECISION s, FTR_PRECISION attack, FTR_PRECISION release) {
+    e->attack = time_shift(s, attack);
+    e->release = time_shift(s, release);
+    envelope_reset(e);
+}
+
+void envelope_prime(EnvelopeFollower* e, int16_t x) { e->env = magnitude(x); }
+
+uint16_t envelope(EnvelopeFollower* e, int16_t x){
+    uint32_t m = magnitude(x), env = e->env;
+    if(m > env) env += (m - env) >> e->attack;
+    else        env -= (env - m) >> e->release;
+    e->env = env;
+    return round16(env);
+}
+
+// --- RMS ---
+
+void rms_reset(RMSMeter* r) {
+    r->pos = 0;
+    r->sum = 0;
+    for(int i=0; i<(1 << RMS_MAX_LOG2); i++) r->buf[i] = 0;
+}
+
+void init_rms(RMSMeter* r, int len) {
+    uint8_t shift = 0;
+    while(shift < RMS_MAX_LOG2 && (2 << shift) <= len) shift++;
+    r->shift = shift;
+    rms_reset(r);
+}
+
+// Squares of +-2^11 are at most 2^22, so 2^7 of them fit 32 bits.
+void rms_update(RMSMeter* r, int16_t x){
+    int16_t old = r->buf[r->pos];
+    r->sum += (uint32_t)((int32_t)x * x) - (uint32_t)((int32_t)old * old);
+    r->buf[r->pos] = x;
+    r->pos = (uint8_t)((r->pos + 1) & ((1 << r->shift) - 1));
+}
+
+uint16_t rms_value(const RMSMeter* r){
+    uint32_t v = (r->sum + ((1u << r->shift) >> 1)) >> r->shift, root = 0, bit = 1u << 30;
+    while(bit > v) bit >>= 2;
+    while(bit){
+        if(v >= root + bit) { v -= root + bit; root = (root >> 1) + bit; }
+        else root >>= 1;
+        bit >>= 2;
+    }
+    return (uint16_t)(root + (v > root)); // round to nearest
+}
+
+// --- Peak hold ---
+
+void peak_hold_reset(PeakHold* p) {
+    p->count = 0;
+    p->peak = 0;
+}
+
+void init_peak_hold(PeakHold* p, FTR_PRECISION s, FTR_PRECISION hold, FTR_PRECISION decay) {
+    FTR_PRECISION h = hold * s + 0.5f;
+    p->hold = (h >= 65535.0f) ? UINT16_MAX : (h <= 0.0f) ? 0 : (uint16_t)h;
+    p->decay = time_shift(s, decay);
+    peak_hold_reset(p);
+}
+
+void peak_hold_prime(PeakHold* p, int16_t x) {
+    p->count = p->hold;
+    p->peak = magnitude(x);
+}
+
+uint16_t peak_hold(PeakHold* p, int16_t x){
+    uint32_t m = magnitude(x);
+    if(m >= p->peak) { p->peak = m; p->count = p->hold; }
+    else if(p->count) p->count--;
+    else p->peak -= (p->peak - m) >> p->decay;
+    return round16(p->peak);
+}
+
+uint16_t envelope_block(EnvelopeFollower* e, const int16_t* in, int n){
+    for(int k=0; k<n; k++) envelope(e, in[k]);
+    return round16(e->env);
+}
+
+uint16_t rms_block(RMSMeter* r, const int16_t* in, int n){
+    for(int k=0; k<n; k++) rms_update(r, in[k]);
+    return rms_value(r);
+}
+
+uint16_t peak_hold_block(PeakHold* p, const int16_t* in, int n){
+    for(int k=0; k<n; k++) peak_hold(p, in[k]);
+    return round16(p->peak);
+}
@@ -22,6 +22,16 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "filter.h"
+#include "filter_design.h"
+#include "cic.h"
+#include "resample.h"
+#include "nlms.h"
+#include "adc_filters.h"
+#include "goertzel.h"
+#include "fft.h"
+#include "level.h"
+#include "pipeline.h"
+#include "crossfade.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -32,6 +42,78 @@
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
 #define SAMPLE_RATE 1000.0f
+// The ADC runs OVERSAMPLE times faster than SAMPLE_RATE; a CIC decimator and its
+// compensation FIR bring it back down before the Butterworth filters. 1 disables it.
+// Keep 1 for now: TIM2 then has 32000 cycles per sample. At 16 it has 2000, and
+// every 16th tick would still run the whole soft-float chain below (FIR, filter,
+// crossfade, resampler), which takes several ticks. Updates would be lost, and the
+// CIC would decimate an irregular stream. That work has to leave the ISR first.
+#define OVERSAMPLE  1
+#define CIC_ORDER   3
+#define CIC_TAPS    9
+// Streamed rate = SAMPLE_RATE * OUTPUT_L / OUTPUT_M, resampled after the filters so
+// the UART carries only what it can. Equal values stream every sample.
+#define OUTPUT_L    1
+#define OUTPUT_M    2
+#define OUTPUT_TAPS 32
+#if OUTPUT_L > RESAMPLE_MAX_COEFS
+#error "OUTPUT_L needs one resampler branch per phase: keep OUTPUT_L/OUTPUT_M in lowest terms, L <= RESAMPLE_MAX_COEFS"
+#endif
+// Mode 4 notches the mains frequency; more harmonics add one biquad each.
+#define MAINS_HZ        50.0f
+#define MAINS_HARMONICS 1
+#define MAINS_Q         10.0f
+// Mode 5 cancels mains adaptively against a synthesized MAINS_HZ reference, so it
+// follows drift the fixed notch cannot. Weights update once per ANC_INTERVAL samples.
+#define ANC_TAPS        4
+#define ANC_MU          983     // 0.03 in Q15
+#define ANC_INTERVAL    4
+// Integer stages on the 12-bit codes ahead of every mode; 0 disables each.
+// Median removes spikes, the average smooths, the DC blocker re-centres on 2048.
+#define PRE_MEDIAN_LEN  0
+#define PRE_AVERAGE_LEN 0
+#define PRE_DC_BLOCK_K  0
+// Tone mode ('g') streams one line per TONE_WINDOW filtered samples with the
+// amplitudes of toneFreqs[] in ADC codes ("T a,b,c") instead of every sample.
+#define STREAM_SAMPLES  0
+#define STREAM_TONES    1
+#define TONE_WINDOW     500
+#define TONE_HOP        500
+// Spectrum mode ('h') captures SPECTRUM_N filtered samples, transforms them in the
+// main loop and streams "S" + one hex byte per bin (8 * log2 |X|^2, 0.75 dB steps),
+// at most SPECTRUM_RATE frames per second. 'r' and a digit set that rate at run time,
+// '0' for frames back to back.
+#define STREAM_SPECTRUM 2
+#define SPECTRUM_LOG2   8       // 256 points at SAMPLE_RATE: 3.9 Hz bins
+#define SPECTRUM_N      (1 << SPECTRUM_LOG2)
+#define SPECTRUM_WINDOW FFT_WINDOW_HANN
+#define SPECTRUM_RATE   2
+#define SPECTRUM_SKIP(rate) ((rate) > 0 && (int)(SAMPLE_RATE / (rate)) > SPECTRUM_N ? (int)(SAMPLE_RATE / (rate)) - SPECTRUM_N : 0)
+// Capture (TIM2) -> process (main loop) -> send (ADC callback) -> sending (UART)
+#define SPEC_CAPTURE    0
+#define SPEC_PROCESS    1
+#define SPEC_SEND       2
+#define SPEC_SENDING    3
+// Level mode ('i') runs envelope, RMS and peak-hold on the filtered signal and
+// streams "L env,rms,peak" in ADC codes every LEVEL_DECIMATE samples.
+#define STREAM_LEVELS   3
+#define LEVEL_DECIMATE  100     // 10 lines/s
+#define LEVEL_ATTACK    0.004f  // s
+#define LEVEL_RELEASE   0.128f
+#define LEVEL_RMS_LEN   64      // samples, power of two
+#define LEVEL_HOLD      0.5f    // s before the peak decays
+#define LEVEL_DECAY     0.25f
+// Pipeline mode ('f', or any ">stages" line such as ">n50,l15,d4", see pipeline.h)
+// collects PIPE_BLOCK samples in TIM2, runs the chain on them in the main loop and
+// plays the outputs back one per sample period, one block later. A decimating
+// chain lowers the stream rate by the product of its factors.
+#define PIPE_MODE       6
+#define PIPE_QUEUE      32      // outputs waiting for TIM2, power of two >= 2 * PIPE_BLOCK
+#define PIPE_CMD_LEN    48
+// Filter switches wait for a SWAP_BLOCK boundary and crossfade over SWAP_FADE
+// samples; a new pipeline chain runs beside the old one for as long.
+#define SWAP_BLOCK      PIPE_BLOCK  // power of two
+#define SWAP_FADE       64          // 64 ms at SAMPLE_RATE
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -52,18 +134,93 @@ volatile uint32_t count = 0;
 
 volatile uint32_t rawSignal = 0;
 volatile uint32_t processedValue = 0;
+volatile uint8_t sampleReady = 0; // processedValue holds a sample not yet sent
 
-char txBuffer[20];
+char txBuffer[4 + 6 * GOERTZEL_MAX_TONES]; // "T" + up to 8 x ",65535" + CR LF
 uint8_t rxBuffer;
+uint8_t* txData = (uint8_t*)txBuffer; // frame in flight (txBuffer or specBuf), for a resend
+uint16_t txLen = 0;
 
 volatile int txReady = 1;
 volatile uint8_t isStreaming = 0;
 volatile uint8_t filterMode = 0;
-
-BWLowPass  filtLPF;
-BWHighPass filtHPF;
-BWBandPass filtBPF;
-BWBandStop filtBSF;
+volatile uint8_t activeMode = 0xFF; // mode the TIM2 callback last ran; 0xFF until the first sample
+volatile uint8_t fadeMode = 0xFF; // outgoing mode while a switch crossfades, else 0xFF
+uint8_t swapPos = 0;       // position in the current SWAP_BLOCK
+float fadeLast = 0.0f;     // latest output of fadeMode
+uint8_t fadeJoined = 0;    // activeMode has produced an output since the switch
+float lastOutput = 0.0f;
+Crossfade modeFade;
+volatile uint8_t streamMode = STREAM_SAMPLES;
+uint8_t activeStream = STREAM_SAMPLES;
+volatile uint8_t tonesReady = 0;
+
+static const float toneFreqs[] = { 10.0f, 50.0f, 100.0f };
+GoertzelBank toneBank;
+
+// One buffer for the samples, the spectrum and the text frame (2 bytes per sample
+// hold "S" + 2 hex digits per bin + CR LF).
+q15_t specBuf[SPECTRUM_N];
+volatile uint8_t specState = SPEC_CAPTURE;
+uint16_t specFill = 0;
+uint16_t specSkip = 0;
+uint16_t specReload = SPECTRUM_SKIP(SPECTRUM_RATE); // specSkip after each frame
+uint8_t specRateNext = 0; // 'r' received: the next byte is the frame rate
+uint16_t specLen = 0;
+
+EnvelopeFollower levelEnv;
+RMSMeter levelRMS;
+PeakHold levelPeak;
+uint16_t levelCount = 0;
+uint16_t levelOut[3]; // env, rms, peak at the last decimation point
+volatile uint8_t levelsReady = 0;
+
+// Stages are only touched by the main loop, between blocks.
+Pipeline filtPipe;
+float pipeIn[2][PIPE_BLOCK];           // TIM2 fills one while the main loop runs the other
+uint8_t pipeBank = 0;
+uint8_t pipeFill = 0;
+volatile uint8_t pipePending = 0xFF;   // bank waiting for the main loop
+volatile uint8_t pipeRestart = 0;    // set by TIM2, cleared by the main loop once reset
+float pipeOut[PIPE_QUEUE];
+volatile uint8_t pipeHead = 0;         // written by the main loop
+volatile uint8_t pipeTail = 0;         // written by TIM2, and by the main loop during a restart
+char pipeCmd[PIPE_CMD_LEN];
+uint8_t pipeCmdLen = 0;
+uint8_t pipeCmdActive = 0;
+volatile uint8_t pipeCmdReady = 0;
+uint8_t pipeRetuned = 0;  // chain replaced while running: fade from pipeLast
+float pipeLast = 0.0f;
+Crossfade pipeFade;
+Pipeline pipeOld;           // outgoing chain while pipeFade runs it beside filtPipe
+float pipeOldBuf[PIPE_BLOCK];
+uint8_t pipeOldActive = 0;
+
+SOSCascade filtLPF;
+SOSCascade filtHPF;
+SOSCascade filtBPF;
+SOSCascade filtNotch;
+NLMSCanceller  anc;
+NLMSOscillator ancRef;
+
+#if PRE_MEDIAN_LEN
+MedianFilter  preMedian;
+#endif
+#if PRE_AVERAGE_LEN
+MovingAverage preAverage;
+#endif
+#if PRE_DC_BLOCK_K
+DCBlocker     preDC;
+#endif
+
+#if OVERSAMPLE > 1
+CICDecimator cic;
+FIRFilter    cicComp;
+uint8_t      cicWarmup = CIC_ORDER + CIC_TAPS; // decimated outputs until the FIR history is valid
+#endif
+#if OUTPUT_L != OUTPUT_M
+Resampler    outRS;
+#endif
 
 /* USER CODE END PV */
 
@@ -76,6 +233,14 @@ static void MX_ADC_Init(void);
 static void MX_TIM2_Init(void);
 /* USER CODE BEGIN PFP */
 void Tiny_UIntToString(uint32_t value, char* buffer);
+uint8_t Run_Filter(uint8_t mode, float input, float* output);
+void Prime_Filter(uint8_t mode, float input);
+void Prime_PreStages(uint16_t code);
+uint8_t Format_Tones(char* buffer);
+uint8_t Format_Levels(char* buffer);
+uint16_t Process_Spectrum(void);
+void Process_Pipeline(void);
+void Send_Frame(uint8_t* data, uint16_t len);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -117,16 +282,46 @@ int main(void)
   MX_ADC_Init();
   MX_TIM2_Init();
   /* USER CODE BEGIN 2 */
+#if OVERSAMPLE > 1
+  // TIM2 triggers the ADC: raise both to OVERSAMPLE * SAMPLE_RATE.
+  __HAL_TIM_SET_AUTORELOAD(&htim2, (htim2.Init.Period + 1) / OVERSAMPLE - 1);
+  init_cic(&cic, CIC_ORDER, OVERSAMPLE);
+  init_cic_compensator(&cicComp, &cic, CIC_TAPS, 0.25f);
+#endif
+#if OUTPUT_L != OUTPUT_M
+  if (init_resampler(&outRS, OUTPUT_L, OUTPUT_M, OUTPUT_TAPS) != 0)
+  {
+    Error_Handler();
+  }
+#endif
+  init_bw_low_pass_sos(&filtLPF, 4, SAMPLE_RATE, 15.0f);
+  init_bw_high_pass_sos(&filtHPF, 4, SAMPLE_RATE, 95.0f);
+  init_bw_band_pass_sos(&filtBPF, 4, SAMPLE_RATE, 45.0f, 55.0f);
+  init_notch_comb(&filtNotch, SAMPLE_RATE, MAINS_HZ, MAINS_HARMONICS, MAINS_Q);
+  init_nlms(&anc, ANC_TAPS, ANC_MU, ANC_INTERVAL);
+  init_nlms_oscillator(&ancRef, SAMPLE_RATE, MAINS_HZ);
+  init_goertzel(&toneBank, SAMPLE_RATE, toneFreqs, sizeof(toneFreqs) / sizeof(toneFreqs[0]), TONE_WINDOW, TONE_HOP, NULL);
+  init_envelope(&levelEnv, SAMPLE_RATE, LEVEL_ATTACK, LEVEL_RELEASE);
+  init_rms(&levelRMS, LEVEL_RMS_LEN);
+  init_peak_hold(&levelPeak, SAMPLE_RATE, LEVEL_HOLD, LEVEL_DECAY);
+  init_pipeline(&filtPipe, SAMPLE_RATE);
+  init_crossfade(&modeFade, SWAP_FADE);
+  init_crossfade(&pipeFade, SWAP_FADE);
+#if PRE_MEDIAN_LEN
+  init_median(&preMedian, PRE_MEDIAN_LEN);
+#endif
+#if PRE_AVERAGE_LEN
+  init_moving_average(&preAverage, PRE_AVERAGE_LEN);
+#endif
+#if PRE_DC_BLOCK_K
+  init_dc_blocker(&preDC, PRE_DC_BLOCK_K);
+#endif
+  // Everything TIM2 touches is ready before its first tick.
   HAL_TIM_Base_Start_IT(&htim2);
   HAL_ADC_Start_DMA(&hadc, (uint32_t*)(void*)&rawSignal, 1);
-  HAL_UART_Transmit_IT(&huart2, (uint8_t*)txBuffer, 1);
+  Send_Frame((uint8_t*)txBuffer, 1);
   HAL_UART_Receive_IT(&huart2, &rxBuffer, 1);
 
-  init_bw_low_pass(&filtLPF, 4, SAMPLE_RATE, 15.0f);
-  init_bw_high_pass(&filtHPF, 4, SAMPLE_RATE, 95.0f);
-  init_bw_band_pass(&filtBPF, 4, SAMPLE_RATE, 45.0f, 55.0f);
-  init_bw_band_stop(&filtBSF, 4, SAMPLE_RATE, 40.0f, 60.0f);
-
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -136,6 +331,12 @@ int main(void)
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
+    // The FFT takes longer than one sample period, so it runs here, not in TIM2.
+    if (specState == SPEC_PROCESS) {
+        specLen = Process_Spectrum();
+        specState = SPEC_SEND;
+    }
+    Process_Pipeline();
   }
   /* USER CODE END 3 */
 }
@@ -379,41 +580,203 @@ static void MX_GPIO_Init(void)
 /* USER CODE BEGIN 4 */
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim){
     if (htim->Instance == TIM2){
+#if OVERSAMPLE > 1
+        uint32_t acc;
+        if (!cic_decimate(&cic, (uint16_t)rawSignal, &acc)) return;
+        float input = fir_filter(&cicComp, (float)acc);
+        if (cicWarmup) { cicWarmup--; return; }
+#else
         float input = (float)rawSignal;
+#endif
+#if PRE_MEDIAN_LEN || PRE_AVERAGE_LEN || PRE_DC_BLOCK_K
+        uint16_t code = (input <= 0.0f) ? 0 : (input >= 4095.0f) ? 4095 : (uint16_t)(input + 0.5f);
+        if (activeMode == 0xFF) Prime_PreStages(code);
+  #if PRE_MEDIAN_LEN
+        code = median_filter(&preMedian, code);
+  #endif
+  #if PRE_AVERAGE_LEN
+        code = moving_average(&preAverage, code);
+  #endif
+  #if PRE_DC_BLOCK_K
+        input = (float)(dc_blocker(&preDC, code) + 2048);
+  #else
+        input = (float)code;
+  #endif
+#endif
         float output = input;
-
-        switch (filterMode) {
-            case 0: // Raw
-                output = input;
-                break;
-            case 1: // LPF
-                // LPF passes DC, so it usually doesn't need bias adjustment
-                output = bw_low_pass(&filtLPF, input);
-                break;
-            case 2: // HPF
-                // HPF removes DC (output centers at 0).
-                // We add 2048 to see the AC signal on the 0-4095 plot.
-                output = bw_high_pass(&filtHPF, input) + 2048.0f;
-                break;
-            case 3: // BPF
-                // BPF also removes DC. Add bias.
-                output = bw_band_pass(&filtBPF, input) + 2048.0f;
-                break;
-            case 4: // BSF
-                // BSF passes DC, so we don't add bias (input DC is preserved)
-                output = bw_band_stop(&filtBSF, input);
-                break;
-            default:
-                output = input;
-                break;
+        uint8_t mode = filterMode;
+
+        // Mode changes take effect at a SWAP_BLOCK boundary once any previous fade
+        // is over. The new filter starts from its steady state for this sample and
+        // the outgoing one keeps running under a SWAP_FADE crossfade, so the output
+        // neither steps nor stops, and TIM2 never runs more than two filters. At
+        // power-up there is nothing to fade from and the switch is immediate.
+        // The fade advances on the ticks the incoming mode has an output, so a
+        // decimating pipeline fades at its own rate; until its first output the
+        // outgoing mode carries the stream alone.
+        if (mode != activeMode && fadeMode == 0xFF && (swapPos == 0 || activeMode == 0xFF)) {
+            Prime_Filter(mode, input);
+            if (activeMode != 0xFF) {
+                fadeMode = activeMode;
+                fadeLast = lastOutput;
+                fadeJoined = 0;
+                crossfade_start(&modeFade, 0.0f);
+            }
+            activeMode = mode;
+        }
+        swapPos = (swapPos + 1) & (SWAP_BLOCK - 1);
+
+        uint8_t ready = Run_Filter(activeMode, input, &output);
+        if (fadeMode != 0xFF) {
+            Run_Filter(fadeMode, input, &fadeLast); // holds its last value between pipeline outputs
+            if (ready) {
+                output = crossfade(&modeFade, fadeLast, output);
+                fadeJoined = 1;
+                if (!crossfade_active(&modeFade)) fadeMode = 0xFF;
+            } else if (!fadeJoined) { // pipeline still filling
+                output = fadeLast;
+                ready = 1;
+            }
+        }
+        if (!ready) return;
+        lastOutput = output;
+
+        // Tone amplitudes of the filtered signal at SAMPLE_RATE, around mid-scale.
+        if (streamMode != activeStream) {
+            goertzel_reset(&toneBank);
+            // The FFT (SPEC_PROCESS) or the UART (SPEC_SENDING) may still be reading
+            // specBuf: that frame completes first, and TxCplt restarts the capture.
+            if (specState == SPEC_CAPTURE || specState == SPEC_SEND) {
+                specFill = 0;
+                specSkip = 0;
+                specState = SPEC_CAPTURE;
+            }
+            envelope_reset(&levelEnv);
+            rms_reset(&levelRMS);
+            peak_hold_reset(&levelPeak);
+            levelCount = 0;
+            activeStream = streamMode;
+        }
+        if (activeStream == STREAM_TONES && goertzel_update(&toneBank, (int16_t)(output - 2048.0f)))
+            tonesReady = 1;
+        if (activeStream == STREAM_SPECTRUM && specState == SPEC_CAPTURE) {
+            if (specSkip) {
+                specSkip--;
+            } else {
+                float v = (output - 2048.0f) * 16.0f; // Q15 around mid-scale
+                specBuf[specFill++] = (v >= 32767.0f) ? 32767 : (v <= -32768.0f) ? -32768 : (q15_t)v;
+                if (specFill == SPECTRUM_N) specState = SPEC_PROCESS;
+            }
+        }
+        if (activeStream == STREAM_LEVELS) {
+            int16_t x = (int16_t)(output - 2048.0f);
+            uint16_t env = envelope(&levelEnv, x);
+            uint16_t peak = peak_hold(&levelPeak, x);
+            rms_update(&levelRMS, x);
+            if (++levelCount >= LEVEL_DECIMATE) {
+                levelCount = 0;
+                if (levelsReady == 0) { // the sender still owns levelOut otherwise
+                    levelOut[0] = env;
+                    levelOut[1] = rms_value(&levelRMS);
+                    levelOut[2] = peak;
+                    levelsReady = 1;
+                }
+            }
         }
 
+#if OUTPUT_L != OUTPUT_M
+        float resampled[(OUTPUT_L + OUTPUT_M - 1) / OUTPUT_M];
+        int produced = resample(&outRS, output, resampled);
+        if (produced == 0) return;
+        output = resampled[produced - 1]; // one value per sample period fits the UART slot
+#endif
+
         // Clamp to safety
         if (output < 0.0f) output = 0.0f;
         if (output > 4095.0f) output = 4095.0f;
 
         processedValue = (uint32_t)output;
+        sampleReady = 1;
+    }
+}
+
+// Runs one mode on the sample; 0 when the mode has no output for it yet.
+uint8_t Run_Filter(uint8_t mode, float input, float* output){
+    switch (mode) {
+        case 0: // Raw
+            *output = input;
+            break;
+        case 1: // LPF
+            // LPF passes DC, so it usually doesn't need bias adjustment
+            *output = sos_cascade_lp(&filtLPF, input);
+            break;
+        case 2: // HPF
+            // HPF removes DC (output centers at 0).
+            // We add 2048 to see the AC signal on the 0-4095 plot.
+            *output = sos_cascade_hp(&filtHPF, input) + 2048.0f;
+            break;
+        case 3: // BPF
+            // BPF also removes DC. Add bias.
+            *output = sos_cascade(&filtBPF, input) + 2048.0f;
+            break;
+        case 4: // Notch
+            // Notch passes DC, so we don't add bias (input DC is preserved)
+            *output = sos_cascade(&filtNotch, input);
+            break;
+        case 5: { // Adaptive mains canceller
+            // Q15 around mid-scale: 12-bit codes << 4, clamped (the CIC FIR can overshoot).
+            float v = (input - 2048.0f) * 16.0f;
+            q15_t d = (v >= 32767.0f) ? 32767 : (v <= -32768.0f) ? -32768 : (q15_t)v;
+            *output = (float)nlms_cancel_q15(&anc, d, nlms_oscillator_next(&ancRef)) * 0.0625f + 2048.0f;
+            break;
+        }
+        case PIPE_MODE: // Run-time chain, centred on 0
+            if (pipeRestart) return 0; // the main loop owns the queue until it resets it
+            pipeIn[pipeBank][pipeFill++] = input - 2048.0f;
+            if (pipeFill == PIPE_BLOCK) {
+                pipeFill = 0;
+                if (pipePending == 0xFF) { // else the main loop is behind: refill this bank
+                    pipePending = pipeBank;
+                    pipeBank ^= 1;
+                }
+            }
+            if (pipeTail == pipeHead) return 0; // nothing processed yet
+            *output = pipeOut[pipeTail & (PIPE_QUEUE - 1)] + 2048.0f;
+            pipeTail++;
+            break;
+        default:
+            *output = input;
+            break;
     }
+    return 1;
+}
+
+void Prime_Filter(uint8_t mode, float input){
+    switch (mode) {
+        case 1: sos_prime_lp(&filtLPF, input); break;
+        case 2: sos_prime_hp(&filtHPF, input); break;
+        case 3: sos_prime(&filtBPF, input); break;
+        case 4: sos_prime(&filtNotch, input); break;
+        case 5: nlms_reset(&anc); break;
+        case PIPE_MODE: // a block may be mid-run: leave the queue to the main loop
+            pipeFill = 0;
+            pipeRestart = 1;
+            break;
+        default: break;
+    }
+}
+
+void Prime_PreStages(uint16_t code){
+#if PRE_MEDIAN_LEN
+    median_prime(&preMedian, code);
+#endif
+#if PRE_AVERAGE_LEN
+    moving_average_prime(&preAverage, code);
+#endif
+#if PRE_DC_BLOCK_K
+    dc_blocker_prime(&preDC, code);
+#endif
+    (void)code;
 }
 
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
@@ -421,28 +784,78 @@ void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
     if (hadc->Instance == ADC1)
     {
         if (isStreaming == 1 && txReady == 1) {
-            txReady = 0;
-
-            Tiny_UIntToString(processedValue, txBuffer);
             uint8_t len = 0;
-            while(txBuffer[len] != '\0') len++;
+            if (streamMode == STREAM_SPECTRUM) {
+                if (specState != SPEC_SEND) return;
+                specState = SPEC_SENDING;
+                txReady = 0;
+                Send_Frame((uint8_t*)specBuf, specLen);
+                return;
+            } else if (streamMode == STREAM_TONES) {
+                if (tonesReady == 0) return;
+                tonesReady = 0;
+                len = Format_Tones(txBuffer);
+            } else if (streamMode == STREAM_LEVELS) {
+                if (levelsReady == 0) return;
+                len = Format_Levels(txBuffer);
+                levelsReady = 0;
+            } else {
+                if (sampleReady == 0) return;
+                sampleReady = 0;
+                Tiny_UIntToString(processedValue, txBuffer);
+                while(txBuffer[len] != '\0') len++;
+            }
+            txReady = 0;
 
-            HAL_UART_Transmit_IT(&huart2, (uint8_t*)txBuffer, len);
+            Send_Frame((uint8_t*)txBuffer, len);
         }
     }
 }
 
+// Every transmit goes through here so HAL_UART_ErrorCallback can resend the whole
+// frame: a tone or level line, or the spectrum frame straight from specBuf.
+void Send_Frame(uint8_t* data, uint16_t len){
+    txData = data;
+    txLen = len;
+    HAL_UART_Transmit_IT(&huart2, data, len);
+}
+
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){
 	if (huart->Instance == USART2){
+		if (specState == SPEC_SENDING) {
+			specFill = 0;
+			specSkip = specReload;
+			specState = SPEC_CAPTURE;
+		}
 		txReady = 1;
 	}
 }
 
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart){
     if (huart->Instance == USART2){
+        // ">stages" up to CR or LF; handed to the main loop as one command.
+        if (pipeCmdActive) {
+            if (rxBuffer == '\r' || rxBuffer == '\n') {
+                pipeCmd[pipeCmdLen] = '\0';
+                pipeCmdActive = 0;
+                pipeCmdReady = 1;
+            } else if (pipeCmdLen < PIPE_CMD_LEN - 1) {
+                pipeCmd[pipeCmdLen++] = rxBuffer;
+            }
+            HAL_UART_Receive_IT(&huart2, &rxBuffer, 1);
+            return;
+        }
+        // "r0".."r9": spectrum frames per second, from the next frame on.
+        if (specRateNext) {
+            specRateNext = 0;
+            if (rxBuffer >= '0' && rxBuffer <= '9') specReload = SPECTRUM_SKIP(rxBuffer - '0');
+            HAL_UART_Receive_IT(&huart2, &rxBuffer, 1);
+            return;
+        }
         switch (rxBuffer) {
             case 's':
                 filterMode = 0;
+                streamMode = STREAM_SAMPLES;
                 isStreaming = 1;
                 if (htim2.State != HAL_TIM_STATE_BUSY) HAL_TIM_Base_Start_IT(&htim2);
                 break;
@@ -462,11 +875,149 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart){
             case 'd':
                 filterMode = 4;
                 break;
+            case 'e':
+                filterMode = 5;
+                break;
+            case 'f':
+                filterMode = PIPE_MODE;
+                break;
+            case '>':
+                if (pipeCmdReady == 0) { // the main loop still reads pipeCmd otherwise
+                    pipeCmdLen = 0;
+                    pipeCmdActive = 1;
+                }
+                break;
+            case 'g':
+                streamMode = STREAM_TONES;
+                isStreaming = 1;
+                if (htim2.State != HAL_TIM_STATE_BUSY) HAL_TIM_Base_Start_IT(&htim2);
+                break;
+            case 'h':
+                streamMode = STREAM_SPECTRUM;
+                isStreaming = 1;
+                if (htim2.State != HAL_TIM_STATE_BUSY) HAL_TIM_Base_Start_IT(&htim2);
+                break;
+            case 'r':
+                specRateNext = 1;
+                break;
+            case 'i':
+                streamMode = STREAM_LEVELS;
+                isStreaming = 1;
+                if (htim2.State != HAL_TIM_STATE_BUSY) HAL_TIM_Base_Start_IT(&htim2);
+                break;
         }
         HAL_UART_Receive_IT(&huart2, &rxBuffer, 1);
     }
 }
 
+// Window, real FFT and log magnitudes in specBuf, then the hex frame over them,
+// last byte first so no unread magnitude is overwritten. Returns the frame length.
+uint16_t Process_Spectrum(void) {
+    static const char hex[] = "0123456789ABCDEF";
+    char* text = (char*)specBuf;
+    uint8_t* mag = (uint8_t*)specBuf;
+    fft_window_q15(specBuf, SPECTRUM_N, SPECTRUM_WINDOW);
+    fft_real_q15(specBuf, SPECTRUM_LOG2);
+    fft_log_mag_q15(specBuf, SPECTRUM_N, mag);
+    for (int k = SPECTRUM_N / 2 - 1; k >= 0; k--) {
+        uint8_t v = mag[k];
+        text[1 + 2 * k] = hex[v >> 4];
+        text[2 + 2 * k] = hex[v & 15];
+    }
+    text[0] = 'S';
+    text[SPECTRUM_N + 1] = '\r';
+    text[SPECTRUM_N + 2] = '\n';
+    return SPECTRUM_N + 3;
+}
+
+// Applies a received ">stages" line and runs the chain over a completed input
+// block, queueing its outputs for TIM2. Stages change only here, between blocks;
+// a chain that only changes parameters keeps its state (see pipeline_parse).
+// A chain replaced while running is crossfaded from the old one, which keeps
+// running on the same input for SWAP_FADE samples. Only a new chain with a fresh
+// decimator phase has no sample-aligned counterpart; it ramps out the step instead.
+// Like a mode switch, a new line waits for the previous fade to end.
+void Process_Pipeline(void) {
+    if (pipeCmdReady && !pipeOldActive) {
+        uint8_t running = (activeMode == PIPE_MODE) && filtPipe.primed;
+        if (running) pipeOld = filtPipe;
+        if (pipeline_parse(&filtPipe, pipeCmd) >= 0) { // otherwise the mode switch fades
+            if (running && (filtPipe.primed || (pipeOld.rate == pipeOld.s && filtPipe.rate == filtPipe.s))) {
+                pipeOldActive = 1;
+                crossfade_start(&pipeFade, 0.0f);
+            } else {
+                pipeOldActive = 0;
+                pipeRetuned = running;
+            }
+            filterMode = PIPE_MODE;
+        }
+        pipeCmdReady = 0;
+    }
+    if (pipeRestart) { // TIM2 stays off the queue until this is cleared
+        pipePending = 0xFF; // drop the block in flight
+        pipeTail = pipeHead; // and any outputs of the old run
+        pipeline_reset(&filtPipe);
+        pipeOldActive = 0;
+        pipeRetuned = 0;
+        pipeRestart = 0;
+        return;
+    }
+    if (pipePending == 0xFF) return;
+
+    float* buf = pipeIn[pipePending];
+    if (pipeOldActive) {
+        for (int k = 0; k < PIPE_BLOCK; k++) pipeOldBuf[k] = buf[k];
+        pipeline_run(&pipeOld, pipeOldBuf, PIPE_BLOCK); // same decimator phase: same count
+    }
+    int n = pipeline_run(&filtPipe, buf, PIPE_BLOCK);
+    if (pipeOldActive) {
+        crossfade_block(&pipeFade, pipeOldBuf, buf, n);
+        pipeOldActive = crossfade_active(&pipeFade);
+    } else {
+        if (pipeRetuned && n > 0) { // ramp out the step between the old chain and the new
+            crossfade_start(&pipeFade, pipeLast - buf[0]);
+            pipeRetuned = 0;
+        }
+        crossfade_offset_block(&pipeFade, buf, n);
+    }
+    if (n > 0) pipeLast = buf[n - 1];
+    uint8_t head = pipeHead;
+    for (int k = 0; k < n && (uint8_t)(head - pipeTail) < PIPE_QUEUE; k++)
+        pipeOut[head++ & (PIPE_QUEUE - 1)] = buf[k];
+    pipeHead = head;
+    pipePending = 0xFF;
+}
+
+// "T a,b,c\r\n" from the last completed tone frame.
+uint8_t Format_Tones(char* buffer) {
+    uint8_t len = 0;
+    buffer[len++] = 'T';
+    for (int i = 0; i < toneBank.tones; i++) {
+        buffer[len++] = i ? ',' : ' ';
+        Tiny_UIntToString(toneBank.amp[i], buffer + len);
+        while (buffer[len] != '\r') len++;
+    }
+    buffer[len++] = '\r';
+    buffer[len++] = '\n';
+    buffer[len] = '\0';
+    return len;
+}
+
+// "L env,rms,peak\r\n" from the last decimation point.
+uint8_t Format_Levels(char* buffer) {
+    uint8_t len = 0;
+    buffer[len++] = 'L';
+    for (int i = 0; i < 3; i++) {
+        buffer[len++] = i ? ',' : ' ';
+        Tiny_UIntToString(levelOut[i], buffer + len);
+        while (buffer[len] != '\r') len++;
+    }
+    buffer[len++] = '\r';
+    buffer[len++] = '\n';
+    buffer[len] = '\0';
+    return len;
+}
+
 void Tiny_UIntToString(uint32_t value, char* buffer) {
     char temp[12];
     int i = 0;
@@ -502,13 +1053,8 @@ void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){
         HAL_UART_Init(&huart2);
         HAL_UART_Receive_IT(&huart2, &rxBuffer, 1);
 
-        // Manual string length calculation
-        uint8_t len = 0;
-        while(txBuffer[len] != '\0') {
-            len++;
-            if(len >= 20) break; // Safety break
-        }
-        HAL_UART_Transmit_IT(&huart2, (uint8_t*)txBuffer, len);
+        // Resend the frame that failed; txReady stays 0 until it completes.
+        HAL_UART_Transmit_IT(&huart2, txData, txLen);
     }
 }
 
@@ -0,0 +1,74 @@
+#include "nlms.h"
+
+#define NLMS_MASK (NLMS_MAX_TAPS - 1)
+
+void nlms_reset(NLMSCanceller* c) {
+    c->pos = 0;
+    c->count = 0;
+    for(int k=0; k<NLMS_MAX_TAPS; k++) { c->w[k] = 0; c->grad[k] = 0; }
+    for(int k=0; k<2*NLMS_MAX_TAPS; k++) c->ref[k] = 0;
+}
+
+void init_nlms(NLMSCanceller* c, int taps, q15_t mu, int interval) {
+    if(taps < 1) taps = 1;
+    if(taps > NLMS_MAX_TAPS) taps = NLMS_MAX_TAPS;
+    if(interval < 1) interval = 1;
+    if(interval > 16) interval = 16;
+    c->taps = taps;
+    c->interval = interval;
+    c->mu = mu;
+    nlms_reset(c);
+}
+
+// Gradient terms e * r (Q30) are summed >> 4, so up to 16 fit 32 bits. The real
+// step mu * sum(e r) / (interval * P), with P = |r|^2 in Q30, is in weight units
+// (mu * 2^32 / (interval * P)) * grad >> 16; eps keeps the factor below 2^27 and
+// the product below 2^57.
+static void nlms_update(NLMSCanceller* c, const q15_t* r) {
+    int64_t p = NLMS_EPSILON;
+    for(int k=0; k<c->taps; k++) p += (int32_t)r[k] * r[k];
+    int64_t factor = ((int64_t)c->mu << 32) / (p * c->interval);
+    for(int k=0; k<c->taps; k++){
+        int64_t w = (int64_t)c->w[k] + ((factor * c->grad[k]) >> 16);
+        c->w[k] = (w > INT32_MAX) ? INT32_MAX : (w < INT32_MIN) ? INT32_MIN : (int32_t)w;
+        c->grad[k] = 0;
+    }
+}
+
+q15_t nlms_cancel_q15(NLMSCanceller* c, q15_t d, q15_t x){
+    int pos = (c->pos - 1) & NLMS_MASK;
+    c->pos = pos;
+    c->ref[pos] = x;
+    c->ref[pos + NLMS_MAX_TAPS] = x;
+
+    const q15_t* r = c->ref + pos;
+    int64_t acc = 1 << (NLMS_WEIGHT_FRAC - 16 - 1);
+    for(int k=0; k<c->taps; k++) acc += (int32_t)(c->w[k] >> 16) * r[k];
+    int32_t e = q15_sat((int32_t)d - (int32_t)(acc >> (NLMS_WEIGHT_FRAC - 16)));
+
+    for(int k=0; k<c->taps; k++) c->grad[k] += (e * r[k]) >> 4;
+    if(++c->count >= c->interval){
+        c->count = 0;
+        nlms_update(c, r);
+    }
+    return (q15_t)e;
+}
+
+void nlms_cancel_block_q15(NLMSCanceller* c, const q15_t* in, const q15_t* ref, q15_t* out, int n){
+    for(int k=0; k<n; k++) out[k] = nlms_cancel_q15(c, in[k], ref[k]);
+}
+
+void init_nlms_oscillator(NLMSOscillator* osc, FTR_PRECISION s, FTR_PRECISION f) {
+    osc->phase = 0;
+    osc->step = (uint32_t)(f / s * 4294967296.0f);
+}
+
+q15_t nlms_oscillator_next(NLMSOscillator* osc){
+    q15_t v = ftr_sin_q15(osc->phase);
+    osc->phase += osc->step;
+    return v;
+}
+
+void nlms_oscillator_block(NLMSOscillator* osc, q15_t* out, int n){
+    for(int k=0; k<n; k++) out[k] = nlms_oscillator_next(osc);
+}
@@ -0,0 +1,289 @@
+#include "pipeline.h"
+#include "filter_design.h"
+
+#define PIPE_MAX_ARGS   3
+
+// Defaults for omitted trailing arguments, per type.
+static const FTR_PRECISION defaults[][PIPE_MAX_ARGS] = {
+    { 6.0f },                   // DC_BLOCK k
+    { 50.0f, 10.0f },           // NOTCH f, q
+    { 15.0f, 4.0f },            // LOW_PASS f, order
+    { 95.0f, 4.0f },            // HIGH_PASS
+    { 45.0f, 55.0f, 4.0f },     // BAND_PASS fl, fu, order
+    { 45.0f, 55.0f, 4.0f },     // BAND_STOP
+    { 1.0f },                   // DECIMATE m
+    { 0.004f, 0.128f },         // ENVELOPE attack, release
+    { 0.5f, 0.25f },            // PEAK hold, decay
+};
+
+static const char letters[] = "cnlhbsdek"; // text form, in enum order
+
+// Whole number in [lo, hi]. The range test comes first: converting a float outside
+// int's range (a long run of digits from the UART) is undefined.
+static int is_int(FTR_PRECISION v, FTR_PRECISION lo, FTR_PRECISION hi) {
+    return v >= lo && v <= hi && v == (FTR_PRECISION)(int)v;
+}
+
+// Rate after a stage with these arguments at rate s, or 0 if they are out of range.
+static FTR_PRECISION stage_check(uint8_t type, const FTR_PRECISION* arg, FTR_PRECISION s) {
+    FTR_PRECISION nyq = 0.5f * s, ord = arg[type >= PIPE_BAND_PASS ? 2 : 1];
+    int order = is_int(ord, 0, 2 * SOS_MAX_SECTIONS) ? (int)ord : 0; // 0 fails every order test
+    switch (type) {
+        case PIPE_DC_BLOCK:
+            return is_int(arg[0], 1.0f, 15.0f) ? s : 0;
+        case PIPE_NOTCH:
+            return (arg[0] > 0 && arg[0] < nyq && arg[1] > 0) ? s : 0;
+        case PIPE_LOW_PASS:
+        case PIPE_HIGH_PASS:
+            if (order < 2 || (order & 1)) return 0;
+            return (arg[0] > 0 && arg[0] < nyq) ? s : 0;
+        case PIPE_BAND_PASS:
+        case PIPE_BAND_STOP:
+            if (order < 4 || (order & 3)) return 0;
+            return (arg[0] > 0 && arg[0] < arg[1] && arg[1] < nyq) ? s : 0;
+        case PIPE_DECIMATE:
+            return is_int(arg[0], 1.0f, 255.0f) ? s / arg[0] : 0;
+        case PIPE_ENVELOPE:
+        case PIPE_PEAK:
+            return (arg[0] >= 0 && arg[1] >= 0) ? s : 0;
+        default:
+            return 0;
+    }
+}
+
+void init_pipeline(Pipeline* p, FTR_PRECISION s) {
+    p->n = 0;
+    p->primed = 0;
+    p->s = s;
+    p->rate = s;
+}
+
+int pipeline_add(Pipeline* p, uint8_t type, const FTR_PRECISION* arg) {
+    if (p->n >= PIPE_MAX_STAGES) return -1;
+    FTR_PRECISION s = p->rate, next = stage_check(type, arg, s);
+    if (next <= 0) return -1;
+    PipeStage* st = &p->stage[p->n];
+    st->type = type;
+    switch (type) {
+        case PIPE_DC_BLOCK:  st->u.dc.r = 1.0f - 1.0f / (FTR_PRECISION)(1 << (int)arg[0]); break;
+        case PIPE_NOTCH:     init_notch(&st->u.sos, s, arg[0], arg[1]); break;
+        case PIPE_LOW_PASS:  init_bw_low_pass_sos(&st->u.sos, (int)arg[1], s, arg[0]); break;
+        case PIPE_HIGH_PASS: init_bw_high_pass_sos(&st->u.sos, (int)arg[1], s, arg[0]); break;
+        case PIPE_BAND_PASS: init_bw_band_pass_sos(&st->u.sos, (int)arg[2], s, arg[0], arg[1]); break;
+        case PIPE_BAND_STOP: init_bw_band_stop_sos(&st->u.sos, (int)arg[2], s, arg[0], arg[1]); break;
+        case PIPE_DECIMATE:
+            st->u.dec.m = (uint8_t)arg[0];
+            st->u.dec.inv = 1.0f / arg[0];
+            break;
+        case PIPE_ENVELOPE:  init_envelope(&st->u.env, s, arg[0], arg[1]); break;
+        case PIPE_PEAK:      init_peak_hold(&st->u.peak, s, arg[0], arg[1]); break;
+    }
+    p->rate = next;
+    p->primed = 0;
+    return ++p->n;
+}
+
+// Unsigned decimal with an optional fraction; advances *text, -1 if no digits.
+static FTR_PRECISION parse_number(const char** text) {
+    const char* c = *text;
+    FTR_PRECISION v = 0, scale = 1.0f;
+    int digits = 0, frac = 0;
+    for (;; c++) {
+        if (*c >= '0' && *c <= '9') {
+            if (frac) { scale *= 0.1f; v += scale * (FTR_PRECISION)(*c - '0'); }
+            else v = 10.0f * v + (FTR_PRECISION)(*c - '0');
+            digits++;
+        } else if (*c == '.' && !frac) {
+            frac = 1;
+        } else {
+            break;
+        }
+    }
+    *text = c;
+    return digits ? v : -1.0f;
+}
+
+// DC gain of section i, (b0+b1+b2)/(1+a1+a2); 0 for the band-pass/high-pass zeros.
+static FTR_PRECISION section_dc(const SOSCascade* f, int i) {
+    return (f->b0[i] + f->b1[i] + f->b2[i]) / (1.0f + f->a1[i] + f->a2[i]);
+}
+
+// Carries the state of 'old' into the freshly designed 'st' of the same type; 0 if
+// the shapes differ (section count, decimation factor) and it must be primed.
+// *ratio is the new over the old DC gain of everything upstream, so the input the
+// stage settled on maps onto the input it will see from here on.
+static int retune_stage(PipeStage* st, const PipeStage* old, FTR_PRECISION* ratio) {
+    switch (st->type) {
+        case PIPE_DC_BLOCK:
+            st->u.dc.x1 = *ratio * old->u.dc.x1;
+            st->u.dc.y1 = *ratio * old->u.dc.y1;
+            *ratio = 1.0f; // no DC passes; nothing downstream to rescale
+            return 1;
+        case PIPE_DECIMATE:
+            if (st->u.dec.m != old->u.dec.m) return 0;
+            st->u.dec.count = old->u.dec.count;
+            st->u.dec.sum = *ratio * old->u.dec.sum;
+            return 1;
+        case PIPE_ENVELOPE:
+            st->u.env.env = old->u.env.env;
+            return 1;
+        case PIPE_PEAK:
+            st->u.peak.peak = old->u.peak.peak;
+            st->u.peak.count = (old->u.peak.count < st->u.peak.hold) ? old->u.peak.count : st->u.peak.hold;
+            return 1;
+        default:
+            if (st->u.sos.n != old->u.sos.n) return 0;
+            // Direct Form II state is the section input over the denominator. The
+            // input moves by the upstream ratio and the denominator by its own, so a
+            // state settled on a constant input lands exactly on the new steady state.
+            // Each section's gain (not only the stage's) matters: band designs spread
+            // the gain unevenly across sections.
+            for (int i = 0; i < st->u.sos.n; i++) {
+                FTR_PRECISION d = 1.0f + st->u.sos.a1[i] + st->u.sos.a2[i];
+                if (d == 0.0f) return 0;
+                FTR_PRECISION k = *ratio * (1.0f + old->u.sos.a1[i] + old->u.sos.a2[i]) / d;
+                st->u.sos.w1[i] = k * old->u.sos.w1[i];
+                st->u.sos.w2[i] = k * old->u.sos.w2[i];
+                FTR_PRECISION gn = section_dc(&st->u.sos, i), go = section_dc(&old->u.sos, i);
+                if (go == 0.0f && gn == 0.0f) *ratio = 1.0f; // no DC passes either way
+                else if (go == 0.0f || gn == 0.0f) return 0; // DC appears or vanishes: no map
+                else *ratio *= gn / go;
+            }
+            return 1;
+    }
+}
+
+int pipeline_parse(Pipeline* p, const char* text) {
+    uint8_t type[PIPE_MAX_STAGES];
+    FTR_PRECISION arg[PIPE_MAX_STAGES][PIPE_MAX_ARGS];
+    FTR_PRECISION s = p->s;
+    int n = 0;
+
+    // Read and check every stage before touching the running chain.
+    while (*text == ' ') text++;
+    while (*text) {
+        int t = 0;
+        while (letters[t] && letters[t] != *text) t++;
+        if (!letters[t] || n >= PIPE_MAX_STAGES) return -1;
+        text++;
+        for (int a = 0; a < PIPE_MAX_ARGS; a++) arg[n][a] = defaults[t][a];
+        for (int a = 0; a < PIPE_MAX_ARGS && *text >= '0' && *text <= '9'; a++) {
+            FTR_PRECISION v = parse_number(&text);
+            arg[n][a] = (t == PIPE_ENVELOPE || t == PIPE_PEAK) ? v * 0.001f : v;
+            if (*text != '/') break;
+            text++;
+        }
+        while (*text == ' ') text++;
+        if (*text == ',') text++;
+        else if (*text) return -1;
+        while (*text == ' ') text++;
+        type[n] = (uint8_t)t;
+        s = stage_check(type[n], arg[n], s);
+        if (s <= 0) return -1;
+        n++;
+    }
+
+    // Same stage types and sizes: new coefficients over the running state.
+    int keep = p->primed && n == p->n;
+    for (int i = 0; keep && i < n; i++) keep = (type[i] == p->stage[i].type);
+    if (!keep) {
+        init_pipeline(p, p->s);
+        for (int i = 0; i < n; i++) pipeline_add(p, type[i], arg[i]);
+        return p->n;
+    }
+    FTR_PRECISION ratio = 1.0f;
+    p->n = 0;
+    p->rate = p->s;
+    for (int i = 0; i < n; i++) {
+        PipeStage old = p->stage[i];
+        pipeline_add(p, type[i], arg[i]);
+        keep = keep && retune_stage(&p->stage[i], &old, &ratio);
+    }
+    p->primed = (uint8_t)keep;
+    return p->n;
+}
+
+void pipeline_reset(Pipeline* p) { p->primed = 0; }
+
+static inline int16_t to_i16(FTR_PRECISION v) {
+    return (v >= 32767.0f) ? 32767 : (v <= -32768.0f) ? -32768 : (int16_t)v;
+}
+
+// Walks the steady state of a constant input x down the chain.
+void pipeline_prime(Pipeline* p, FTR_PRECISION x) {
+    for (int i = 0; i < p->n; i++) {
+        PipeStage* st = &p->stage[i];
+        switch (st->type) {
+            case PIPE_DC_BLOCK:
+                st->u.dc.x1 = x;
+                st->u.dc.y1 = 0;
+                x = 0;
+                break;
+            case PIPE_DECIMATE:
+                st->u.dec.count = 0;
+                st->u.dec.sum = 0;
+                break;
+            case PIPE_ENVELOPE:
+                envelope_prime(&st->u.env, to_i16(x));
+                x = (FTR_PRECISION)envelope(&st->u.env, to_i16(x));
+                break;
+            case PIPE_PEAK:
+                peak_hold_prime(&st->u.peak, to_i16(x));
+                x = (FTR_PRECISION)peak_hold(&st->u.peak, to_i16(x));
+                break;
+            default:
+                sos_prime(&st->u.sos, x);
+                x = sos_cascade(&st->u.sos, x); // DC gain; the state stays put
+                break;
+        }
+    }
+    p->primed = 1;
+}
+
+int pipeline_run(Pipeline* p, FTR_PRECISION* buf, int n) {
+    if (n > 0 && !p->primed) pipeline_prime(p, buf[0]);
+    for (int i = 0; i < p->n && n > 0; i++) {
+        PipeStage* st = &p->stage[i];
+        switch (st->type) {
+            case PIPE_DC_BLOCK: {
+                FTR_PRECISION r = st->u.dc.r, x1 = st->u.dc.x1, y1 = st->u.dc.y1;
+                for (int k = 0; k < n; k++) {
+                    FTR_PRECISION x = buf[k];
+                    y1 = x - x1 + r * y1;
+                    x1 = x;
+                    buf[k] = y1;
+                }
+                st->u.dc.x1 = x1;
+                st->u.dc.y1 = y1;
+                break;
+            }
+            case PIPE_DECIMATE: {
+                uint8_t m = st->u.dec.m, count = st->u.dec.count;
+                FTR_PRECISION sum = st->u.dec.sum;
+                int out = 0;
+                for (int k = 0; k < n; k++) {
+                    sum += buf[k];
+                    if (++count == m) {
+                        buf[out++] = sum * st->u.dec.inv;
+                        sum = 0;
+                        count = 0;
+                    }
+                }
+                st->u.dec.count = count;
+                st->u.dec.sum = sum;
+                n = out;
+                break;
+            }
+            case PIPE_ENVELOPE:
+                for (int k = 0; k < n; k++) buf[k] = (FTR_PRECISION)envelope(&st->u.env, to_i16(buf[k]));
+                break;
+            case PIPE_PEAK:
+                for (int k = 0; k < n; k++) buf[k] = (FTR_PRECISION)peak_hold(&st->u.peak, to_i16(buf[k]));
+                break;
+            default:
+                sos_cascade_block(&st->u.sos, buf, buf, n);
+                break;
+        }
+    }
+    return n;
+}
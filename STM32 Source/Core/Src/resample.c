@@ -0,0 +1,132 @@
+#include "resample.h"
+
+#define RESAMPLE_MASK (RESAMPLE_MAX_TAPS - 1)
+
+// --- Designers ---
+
+static int gcd(int a, int b) {
+    while(b) { int t = a % b; a = b; b = t; }
+    return a;
+}
+
+void resampler_reset(Resampler* r) {
+    r->phase = 0;
+    r->pos = 0;
+    for(int k=0; k<2*RESAMPLE_MAX_TAPS; k++) r->hist[k] = 0;
+}
+
+int init_resampler(Resampler* r, int L, int M, int taps) {
+    if(L < 1) L = 1;
+    if(M < 1) M = 1;
+    int g = gcd(L, M);
+    L /= g; M /= g;
+    if(L > RESAMPLE_MAX_COEFS){
+        // No branch per output phase: pass samples through rather than run the wrong rate.
+        r->L = 1;
+        r->M = 1;
+        r->taps = 1;
+        r->h[0] = 1.0f;
+        resampler_reset(r);
+        return -1;
+    }
+    if(taps > RESAMPLE_MAX_TAPS) taps = RESAMPLE_MAX_TAPS;
+    if(taps > RESAMPLE_MAX_COEFS / L) taps = RESAMPLE_MAX_COEFS / L;
+    if(taps < 1) taps = 1;
+    r->L = L;
+    r->M = M;
+    r->taps = taps;
+
+    // Prototype tap i = k * L + p goes to branch p, position k.
+    int n = L * taps;
+    FTR_PRECISION fc = 0.9f / (FTR_PRECISION)(L > M ? L : M);  // 0.45 of the lower rate, over the upsampled Nyquist
+    FTR_PRECISION mid = 0.5f * (FTR_PRECISION)(n - 1);
+    for(int i=0; i<n; i++){
+        FTR_PRECISION m = (FTR_PRECISION)i - mid;
+        FTR_PRECISION v = (m == 0.0f) ? fc : ftr_sin(M_PI * fc * m) / (M_PI * m);
+        if(n > 1) v *= 0.54f - 0.46f * ftr_cos(2.0f * M_PI * (FTR_PRECISION)i / (FTR_PRECISION)(n - 1));
+        r->h[(i % L) * taps + i / L] = v;
+    }
+    // Unity DC gain per branch, so a constant input gives a constant output.
+    for(int p=0; p<L; p++){
+        FTR_PRECISION* h = r->h + p * taps;
+        FTR_PRECISION s = 0;
+        for(int k=0; k<taps; k++) s += h[k];
+        if(s != 0.0f) for(int k=0; k<taps; k++) h[k] /= s;
+    }
+    resampler_reset(r);
+    return 0;
+}
+
+void resampler_reset_q15(ResamplerQ15* r) {
+    r->phase = 0;
+    r->pos = 0;
+    for(int k=0; k<2*RESAMPLE_MAX_TAPS; k++) r->hist[k] = 0;
+}
+
+void resampler_quantize_q15(ResamplerQ15* r, const Resampler* ref) {
+    r->L = ref->L;
+    r->M = ref->M;
+    r->taps = ref->taps;
+    for(int k=0; k<ref->L*ref->taps; k++){
+        FTR_PRECISION v = ref->h[k] * 32768.0f;
+        v += (v < 0) ? -0.5f : 0.5f;
+        r->h[k] = (v >= 32767.0f) ? INT16_MAX : (v <= -32767.0f) ? -INT16_MAX : (q15_t)v;
+    }
+    resampler_reset_q15(r);
+}
+
+// --- Kernels ---
+// The newest input is at hist[pos] (mirrored at pos + RESAMPLE_MAX_TAPS). After it
+// arrives, every output whose position falls in [0, L) past it is due; each is one
+// branch dot product, and the phase then advances by M. Crossing L means the next
+// output needs the next input.
+
+int resample(Resampler* r, FTR_PRECISION x, FTR_PRECISION* out){
+    int pos = (r->pos - 1) & RESAMPLE_MASK;
+    r->pos = pos;
+    r->hist[pos] = x;
+    r->hist[pos + RESAMPLE_MAX_TAPS] = x;
+
+    const FTR_PRECISION* w = r->hist + pos;
+    int taps = r->taps, phase = r->phase, count = 0;
+    while(phase < r->L){
+        const FTR_PRECISION* h = r->h + phase * taps;
+        FTR_PRECISION acc = 0;
+        for(int k=0; k<taps; k++) acc += h[k] * w[k];
+        out[count++] = acc;
+        phase += r->M;
+    }
+    r->phase = phase - r->L;
+    return count;
+}
+
+int resample_q15(ResamplerQ15* r, q15_t x, q15_t* out){
+    int pos = (r->pos - 1) & RESAMPLE_MASK;
+    r->pos = pos;
+    r->hist[pos] = x;
+    r->hist[pos + RESAMPLE_MAX_TAPS] = x;
+
+    const q15_t* w = r->hist + pos;
+    int taps = r->taps, phase = r->phase, count = 0;
+    while(phase < r->L){
+        const q15_t* h = r->h + phase * taps;
+        int64_t acc = 1 << 14;
+        for(int k=0; k<taps; k++) acc += (int32_t)h[k] * w[k];
+        out[count++] = q15_sat((int32_t)(acc >> 15));
+        phase += r->M;
+    }
+    r->phase = phase - r->L;
+    return count;
+}
+
+int resample_block(Resampler* r, const FTR_PRECISION* in, int n, FTR_PRECISION* out){
+    int count = 0;
+    for(int k=0; k<n; k++) count += resample(r, in[k], out + count);
+    return count;
+}
+
+int resample_block_q15(ResamplerQ15* r, const q15_t* in, int n, q15_t* out){
+    int count = 0;
+    for(int k=0; k<n; k++) count += resample_q15(r, in[k], out + count);
+    return count;
+}
@@ -1,7 +1,7 @@
 import serial
 import matplotlib.pyplot as plt
 import matplotlib.animation as animation
-from matplotlib.widgets import Button
+from matplotlib.widgets import Button, TextBox
 import numpy as np
 from collections import deque
 import sys
@@ -10,7 +10,11 @@ import sys
 SERIAL_PORT = '/dev/ttyACM0' 
 BAUD_RATE = 115200 
 MAX_POINTS = 512  # Increased for better FFT resolution
-FS = 1000 # Estimated Sampling Frequency (Hz) - Adjust based on your device
+FS = 500 # Stream rate (Hz): SAMPLE_RATE * OUTPUT_L / OUTPUT_M in main.c
+TONE_FREQS = [10, 50, 100] # toneFreqs[] in main.c, reported by the Tones mode
+SPEC_N = 256       # SPECTRUM_N in main.c: device FFT size at SPEC_FS
+SPEC_FS = 1000     # SAMPLE_RATE in main.c
+SPEC_GAIN = 0.5    # coherent gain of SPECTRUM_WINDOW (Hann)
 
 # --- SETUP SERIAL ---
 try:
@@ -26,7 +30,7 @@ data = deque([0] * MAX_POINTS, maxlen=MAX_POINTS)
 
 # --- SETUP PLOT ---
 fig, (ax1, ax2) = plt.subplots(2, 1, figsize=(10, 8))
-plt.subplots_adjust(hspace=0.4, bottom=0.2) 
+plt.subplots_adjust(hspace=0.4, bottom=0.25) 
 ax1.set_title("Real-Time ADC Data")
 ax1.set_xlabel("Time (Samples)")
 ax1.set_ylabel("ADC Value")
@@ -39,6 +43,8 @@ ax2.set_ylabel("Magnitude")
 ax2.set_xlim(0, FS / 2)
 ax2.set_ylim(0, 1000)
 line_fft, = ax2.plot([], [], color='r')
+line_tones, = ax2.plot([], [], 'bo')
+level_text = ax2.text(0.02, 0.9, '', transform=ax2.transAxes)
 
 def send_cmd(byte_cmd):
     if ser.is_open:
@@ -53,11 +59,16 @@ def lpf_click(event):   send_cmd(b'a')
 def hpf_click(event):   send_cmd(b'b')
 def bpf_click(event):   send_cmd(b'c')
 def bsf_click(event):   send_cmd(b'd') 
+def anc_click(event):   send_cmd(b'e')
+def tones_click(event): send_cmd(b'g')
+def spec_click(event):  send_cmd(b'h')
+def level_click(event): send_cmd(b'i')
 def pause_click(event): send_cmd(b'p')
+def pipe_submit(text): send_cmd(b'>' + text.strip().encode('ascii') + b'\n')
 
-btn_width = 0.12
+btn_width = 0.072
 btn_height = 0.075
-spacing = 0.02
+spacing = 0.01
 start_x = 0.08
 
 # 1. START
@@ -80,29 +91,81 @@ ax_bpf = plt.axes([start_x + 3*(btn_width + spacing), 0.05, btn_width, btn_heigh
 btn_bpf = Button(ax_bpf, 'BPF', color='#cfe2f3', hovercolor='#9fc5e8')
 btn_bpf.on_clicked(bpf_click)
 
-# 5. BSF 
+# 5. NOTCH
 ax_bsf = plt.axes([start_x + 4*(btn_width + spacing), 0.05, btn_width, btn_height])
-btn_bsf = Button(ax_bsf, 'BSF', color='#cfe2f3', hovercolor='#9fc5e8')
+btn_bsf = Button(ax_bsf, 'Notch', color='#cfe2f3', hovercolor='#9fc5e8')
 btn_bsf.on_clicked(bsf_click)
 
-# 6. PAUSE
-ax_pause = plt.axes([start_x + 5*(btn_width + spacing), 0.05, btn_width, btn_height])
+# 6. ADAPTIVE CANCELLER
+ax_anc = plt.axes([start_x + 5*(btn_width + spacing), 0.05, btn_width, btn_height])
+btn_anc = Button(ax_anc, 'ANC', color='#cfe2f3', hovercolor='#9fc5e8')
+btn_anc.on_clicked(anc_click)
+
+# 7. TONES (on-device Goertzel amplitudes only)
+ax_tones = plt.axes([start_x + 6*(btn_width + spacing), 0.05, btn_width, btn_height])
+btn_tones = Button(ax_tones, 'Tones', color='#fff2cc', hovercolor='#ffe599')
+btn_tones.on_clicked(tones_click)
+
+# 8. SPECTRUM (on-device FFT frames)
+ax_spec = plt.axes([start_x + 7*(btn_width + spacing), 0.05, btn_width, btn_height])
+btn_spec = Button(ax_spec, 'Spectrum', color='#fff2cc', hovercolor='#ffe599')
+btn_spec.on_clicked(spec_click)
+
+# 9. LEVELS
+ax_level = plt.axes([start_x + 8*(btn_width + spacing), 0.05, btn_width, btn_height])
+btn_level = Button(ax_level, 'Levels', color='#fff2cc', hovercolor='#ffe599')
+btn_level.on_clicked(level_click)
+
+# 10. PAUSE
+ax_pause = plt.axes([start_x + 9*(btn_width + spacing), 0.05, btn_width, btn_height])
 btn_pause = Button(ax_pause, 'Pause', color='#f4cccc', hovercolor='#ea9999')
 btn_pause.on_clicked(pause_click)
 
+# Pipeline: stages such as "n50,l15,d4" (see pipeline.h), sent on Enter
+ax_pipe = plt.axes([start_x + 0.1, 0.14, 0.5, 0.05])
+box_pipe = TextBox(ax_pipe, 'Pipeline ', initial='n50,l15')
+box_pipe.on_submit(pipe_submit)
+
 def animate(i):
+    got_samples = False
     while ser.is_open and ser.in_waiting:
         try:
             serial_string = ser.readline().decode('utf-8').strip()
-            if serial_string:
+            if serial_string.startswith('T'):
+                # Tone mode: amplitudes computed on the device, no FFT needed
+                amps = [int(v) for v in serial_string[1:].split(',')]
+                line_fft.set_data([], [])
+                line_tones.set_data(TONE_FREQS[:len(amps)], amps)
+                level_text.set_text('')
+                if max(amps) > 0:
+                    ax2.set_ylim(0, max(amps) * 1.2)
+            elif serial_string.startswith('S'):
+                # Spectrum mode: one hex byte per bin, 8 * log2 |X|^2 of X / SPEC_N
+                codes = bytes.fromhex(serial_string[1:])
+                freqs = np.arange(len(codes)) * SPEC_FS / SPEC_N
+                mags = np.array([2 ** (c / 16) * 2 / SPEC_GAIN / 16 if c else 0.0 for c in codes])
+                line_fft.set_data(freqs, mags)
+                line_tones.set_data([], [])
+                ax2.set_xlim(0, SPEC_FS / 2)
+                level_text.set_text('')
+                if np.max(mags) > 0:
+                    ax2.set_ylim(0, np.max(mags) * 1.2)
+            elif serial_string.startswith('L'):
+                # Level mode: envelope, RMS and held peak in ADC codes around mid-scale
+                env, rms, peak = [int(v) for v in serial_string[1:].split(',')]
+                level_text.set_text(f"Envelope {env}   RMS {rms}   Peak {peak}")
+                line_fft.set_data([], [])
+                line_tones.set_data([], [])
+            elif serial_string:
                 val = int(serial_string)
                 data.append(val)
+                got_samples = True
         except (ValueError, serial.SerialException):
             pass
     
     line.set_ydata(data)
     
-    if len(data) == MAX_POINTS:
+    if got_samples and len(data) == MAX_POINTS:
         signal = np.array(data)
         signal_ac = signal - np.mean(signal)
         
@@ -114,11 +177,14 @@ def animate(i):
         fft_mag = np.abs(fft_vals)[pos_mask] / len(signal) * 2 
         
         line_fft.set_data(fft_freqs, fft_mag)
+        line_tones.set_data([], [])
+        level_text.set_text('')
+        ax2.set_xlim(0, FS / 2)
         
         if np.max(fft_mag) > 0:
              ax2.set_ylim(0, np.max(fft_mag) * 1.2)
 
-    return line, line_fft
+    return line, line_fft, line_tones, level_text
 
 # --- START ANIMATION ---
 ani = animation.FuncAnimation(fig, animate, interval=20, blit=True)